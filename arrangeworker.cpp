@@ -0,0 +1,63 @@
+#include "arrangeworker.h"
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <cmath>
+#include "bottomleftfill.h"
+#include "instrumentation.h"
+
+ArrangeWorker::ArrangeWorker(std::vector<nest::Part> parts, nest::nfpcalculator* nfpCalc, const nest::AnnealConfig& config,
+                             std::shared_ptr<std::atomic<bool>> stop)
+    : parts(std::move(parts)), nfpCalc(nfpCalc), config(config), stopRequested(std::move(stop))
+{
+    for (const nest::Part& part : this->parts) {
+        partArea += std::abs(nest::signedArea(part.outline)) * part.scale * part.scale;
+    }
+}
+
+// Part area over the area of the layout's bounding rectangle
+double ArrangeWorker::utilization(const nest::NestResult& result) const
+{
+    const double area = nest::computeCost(parts, result.placements);
+    return area > 0 ? partArea / area : 0.0;
+}
+
+void ArrangeWorker::run()
+{
+    // Instrumented builds (CONFIG+=nest_instrument) profile each arrangement
+    const bool profiling = nest::instrumentation::enabled();
+    if (profiling) {
+        nest::instrumentation::reset();
+        nest::instrumentation::setTracing(true);
+    }
+
+    // Start from the bottom-left fill nest rather than the scene positions
+    nest::BottomLeftFill placer(parts, *nfpCalc);
+    placer.setStopFlag(stopRequested.get());
+    nest::NestResult result = placer.run();
+    emit progress(result, utilization(result), 0.0);
+
+    if (!*stopRequested) {
+        // Only the timer's owner reads it: the callback runs on this thread
+        QElapsedTimer sinceProgress;
+        sinceProgress.start();
+        nest::Annealer annealer(parts, *nfpCalc, config);
+        annealer.setStopFlag(stopRequested.get());
+        annealer.setProgressCallback([&](const nest::NestResult& best, double fraction) {
+            if (sinceProgress.elapsed() < progressInterval) return;
+            sinceProgress.restart();
+            emit progress(best, utilization(best), fraction);
+        });
+        result = annealer.run(result.placements);
+    }
+
+    if (profiling) {
+        nest::instrumentation::setTracing(false);
+        const QDir dataDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
+        nest::instrumentation::writeJson(dataDir.filePath("arrange-stats.json").toStdString());
+        nest::instrumentation::writeChromeTrace(dataDir.filePath("arrange-trace.json").toStdString());
+        qDebug() << "Arrangement counters and trace written to" << dataDir.path();
+    }
+    emit finished(result, utilization(result), stopRequested->load());
+}
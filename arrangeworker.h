@@ -0,0 +1,48 @@
+#ifndef ARRANGEWORKER_H
+#define ARRANGEWORKER_H
+
+#include <QObject>
+#include <QMetaType>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "annealer.h"
+
+// Runs a full arrangement (bottom-left fill, then annealing) on a snapshot of
+// the scene. Meant to be moved to its own QThread: run() blocks that thread,
+// and results come back to the GUI through queued signals.
+class ArrangeWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    // Setting stop, from any thread, makes run() finish promptly with the
+    // best layout so far. The flag is shared so the owner can set it without
+    // touching the worker, which deletes itself once its thread stops.
+    ArrangeWorker(std::vector<nest::Part> parts, nest::nfpcalculator* nfpCalc, const nest::AnnealConfig& config,
+                  std::shared_ptr<std::atomic<bool>> stop);
+
+public slots:
+    void run();
+
+signals:
+    // Best layout so far, at most every progressInterval ms. fraction is the
+    // share of the cooling schedule done.
+    void progress(const nest::NestResult& best, double utilization, double fraction);
+    void finished(const nest::NestResult& result, double utilization, bool cancelled);
+
+private:
+    double utilization(const nest::NestResult& result) const;
+
+    static constexpr int progressInterval = 100;
+
+    std::vector<nest::Part> parts;
+    nest::nfpcalculator* nfpCalc;
+    nest::AnnealConfig config;
+    std::shared_ptr<std::atomic<bool>> stopRequested;
+    double partArea = 0.0;
+};
+
+Q_DECLARE_METATYPE(nest::NestResult)
+
+#endif // ARRANGEWORKER_H
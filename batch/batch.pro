@@ -0,0 +1,14 @@
+# Headless batch nesting of job files. No Qt modules needed.
+TEMPLATE = app
+TARGET = nestbatch
+CONFIG += console c++17 thread
+CONFIG -= app_bundle qt
+
+include(../nest/nest.pri)
+
+SOURCES += \
+    job.cpp \
+    main.cpp
+
+HEADERS += \
+    job.h
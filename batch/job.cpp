@@ -0,0 +1,257 @@
+#include "job.h"
+#include "partimport.h"
+#include "shapes.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace nest;
+
+// Whitespace separated tokens up to a '#'; double quotes group a name with spaces
+static bool tokenize(const std::string& line, std::vector<std::string>& tokens)
+{
+    tokens.clear();
+    size_t i = 0;
+    while (i < line.size()) {
+        const char c = line[i];
+        if (c == '#') break;
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+        } else if (c == '"') {
+            const size_t end = line.find('"', i + 1);
+            if (end == std::string::npos) return false;
+            tokens.push_back(line.substr(i + 1, end - i - 1));
+            i = end + 1;
+        } else {
+            size_t end = i;
+            while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end])) && line[end] != '#') ++end;
+            tokens.push_back(line.substr(i, end - i));
+            i = end;
+        }
+    }
+    return true;
+}
+
+static bool toNumber(const std::string& token, double& value)
+{
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(token.c_str(), &end);
+    return !token.empty() && *end == '\0' && errno == 0 && std::isfinite(value);
+}
+
+static bool toQuantity(const std::string& token, int& value)
+{
+    double number = 0.0;
+    if (!toNumber(token, number) || number < 1 || number > 1e6 || number != std::floor(number)) return false;
+    value = int(number);
+    return true;
+}
+
+// FILE as written in a job, relative to the job file's directory
+static std::string relativeTo(const std::string& jobPath, const std::string& file)
+{
+    const size_t slash = jobPath.find_last_of('/');
+    if (file.empty() || file[0] == '/' || slash == std::string::npos) return file;
+    return jobPath.substr(0, slash + 1) + file;
+}
+
+static std::string quotedName(const std::string& name)
+{
+    return name.find_first_of(" \t#") == std::string::npos && !name.empty() ? name : "\"" + name + "\"";
+}
+
+bool readJob(const std::string& path, Job& job, std::string& error)
+{
+    job = Job();
+    job.path = path;
+    std::ifstream file(path);
+    if (!file) {
+        error = path + ": cannot open";
+        return false;
+    }
+
+    std::string line;
+    std::vector<std::string> tokens;
+    ImportOptions importOptions;
+    int lineNumber = 0;
+    auto fail = [&](const std::string& message) {
+        error = path + ":" + std::to_string(lineNumber) + ": " + message;
+        return false;
+    };
+    auto addCopies = [&job](const Part& part, int quantity) {
+        for (int copy = 1; copy <= quantity; ++copy) {
+            job.parts.push_back(part);
+            job.copies.push_back(copy);
+        }
+    };
+
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (!tokenize(line, tokens)) return fail("unterminated quote");
+        if (tokens.empty()) continue;
+        const std::string& keyword = tokens[0];
+
+        if (keyword == "sheet" || keyword == "sheets") {
+            if (tokens.size() != 3 || !toNumber(tokens[1], job.sheetWidth) || !toNumber(tokens[2], job.sheetHeight) ||
+                job.sheetWidth <= 0 || job.sheetHeight <= 0) {
+                return fail("expected: " + keyword + " WIDTH HEIGHT");
+            }
+            job.multiSheet = keyword == "sheets";
+        } else if (keyword == "rotations") {
+            job.rotations.clear();
+            for (size_t i = 1; i < tokens.size(); ++i) {
+                double angle = 0.0;
+                if (!toNumber(tokens[i], angle)) return fail("bad rotation '" + tokens[i] + "'");
+                job.rotations.push_back(angle);
+            }
+            if (job.rotations.empty()) return fail("expected: rotations A B ...");
+        } else if (keyword == "part") {
+            int quantity = 0;
+            if (tokens.size() < 3 || !toQuantity(tokens[2], quantity)) return fail("expected: part NAME QUANTITY X1 Y1 ...");
+            if (tokens.size() % 2 == 0 || tokens.size() < 9) return fail("a part needs three or more X Y pairs");
+            Polygon outline;
+            for (size_t i = 3; i < tokens.size(); i += 2) {
+                Point p;
+                if (!toNumber(tokens[i], p.x) || !toNumber(tokens[i + 1], p.y)) {
+                    return fail("bad coordinate '" + tokens[i] + " " + tokens[i + 1] + "'");
+                }
+                outline.push_back(p);
+            }
+            if (std::abs(signedArea(outline)) <= 0.0) return fail("part '" + tokens[1] + "' has no area");
+            addCopies(makePart(tokens[1], outline), quantity);
+        } else if (keyword == "shape") {
+            int quantity = 0;
+            double scale = 1.0;
+            if (tokens.size() < 3 || tokens.size() > 4 || !toQuantity(tokens[2], quantity) ||
+                (tokens.size() == 4 && (!toNumber(tokens[3], scale) || scale <= 0))) {
+                return fail("expected: shape NAME QUANTITY [SCALE]");
+            }
+            const Polygon outline = shapeOutline(tokens[1]);
+            if (outline.empty()) return fail("unknown shape '" + tokens[1] + "'");
+            addCopies(makePart(tokens[1], outline, scale), quantity);
+        } else if (keyword == "tolerance") {
+            if (tokens.size() != 2 || !toNumber(tokens[1], importOptions.tolerance) || importOptions.tolerance <= 0) {
+                return fail("expected: tolerance T");
+            }
+        } else if (keyword == "import") {
+            int quantity = 1;
+            importOptions.scale = 1.0;
+            if (tokens.size() < 2 || tokens.size() > 4 || (tokens.size() > 2 && !toQuantity(tokens[2], quantity)) ||
+                (tokens.size() == 4 && (!toNumber(tokens[3], importOptions.scale) || importOptions.scale <= 0))) {
+                return fail("expected: import FILE [QUANTITY [SCALE]]");
+            }
+            PartLibrary library;
+            std::string importError;
+            if (!importFile(relativeTo(path, tokens[1]), library, importOptions, importError)) return fail(importError);
+            if (library.size() == 0) return fail("no closed outlines in '" + tokens[1] + "'");
+
+            // Layer names repeat across different outlines; results need to tell them apart
+            std::unordered_map<std::string, int> uses;
+            for (size_t i = 0; i < library.size(); ++i) ++uses[library.entry(i).name];
+            for (size_t i = 0; i < library.size(); ++i) {
+                const std::string& base = library.entry(i).name;
+                const std::string name = uses[base] > 1 ? base + "#" + std::to_string(i + 1) : base;
+                addCopies(makePart(name, library.outline(i), 1.0, library.holes(i)),
+                          library.entry(i).quantity * quantity);
+            }
+        } else {
+            return fail("unknown directive '" + keyword + "'");
+        }
+    }
+    if (file.bad()) return fail("read error");
+    if (job.parts.empty()) {
+        error = path + ": no parts";
+        return false;
+    }
+    return true;
+}
+
+JobResult finishJob(const Job& job, const NestResult& result)
+{
+    JobResult finished;
+    double partArea = 0.0;
+    for (size_t i = 0; i < job.parts.size(); ++i) {
+        const Part& part = job.parts[i];
+        partArea += std::abs(signedArea(part.outline)) * part.scale * part.scale;
+        finished.extent = finished.extent.united(boundingRect(placedOutline(part, result.placements[i])));
+    }
+
+    const Point shift{-finished.extent.minX, -finished.extent.minY};
+    finished.placements = result.placements;
+    for (Placement& placement : finished.placements) placement.position = placement.position + shift;
+    finished.extent = finished.extent.translated(shift);
+
+    const double area = finished.extent.area();
+    finished.utilization = area > 0 ? partArea / area : 0.0;
+    if (job.sheetWidth > 0) {
+        finished.sheetUtilization = partArea / (job.sheetWidth * job.sheetHeight);
+        const double tolerance = 1e-9 * std::max(job.sheetWidth, job.sheetHeight);
+        finished.fits = finished.extent.width() <= job.sheetWidth + tolerance &&
+                        finished.extent.height() <= job.sheetHeight + tolerance;
+    }
+    return finished;
+}
+
+JobResult finishJob(const Job& job, const SheetsResult& result)
+{
+    JobResult finished;
+    finished.placements = result.placements;
+    finished.sheets = result.sheets;
+    finished.sheetCount = result.sheetCount;
+    std::vector<Rect> used(size_t(result.sheetCount));
+    double partArea = 0.0;
+    for (size_t i = 0; i < job.parts.size(); ++i) {
+        const int sheet = result.sheets[i];
+        if (sheet < 0) {
+            finished.fits = false;
+            continue;
+        }
+        const Part& part = job.parts[i];
+        partArea += std::abs(signedArea(part.outline)) * part.scale * part.scale;
+        const Rect bounds = boundingRect(placedOutline(part, result.placements[i]));
+        used[size_t(sheet)] = used[size_t(sheet)].united(bounds);
+        finished.extent = finished.extent.united(bounds);
+    }
+
+    double usedArea = 0.0;
+    for (const Rect& rect : used) usedArea += rect.area();
+    finished.utilization = usedArea > 0 ? partArea / usedArea : 0.0;
+    const double sheetArea = result.sheetCount * job.sheetWidth * job.sheetHeight;
+    finished.sheetUtilization = sheetArea > 0 ? partArea / sheetArea : 0.0;
+    return finished;
+}
+
+bool writeResult(const std::string& path, const Job& job, const JobResult& result, std::string& error)
+{
+    std::ostringstream out;
+    out.precision(10);
+    out << "# nestbatch result for " << job.path << "\n";
+    out << "utilization " << result.utilization << "\n";
+    if (job.multiSheet) out << "sheets " << result.sheetCount << "\n";
+    if (job.sheetWidth > 0) {
+        out << "sheet_utilization " << result.sheetUtilization << "\n";
+        out << "fits " << (result.fits ? "yes" : "no") << "\n";
+    }
+    out << "extent " << result.extent.width() << " " << result.extent.height() << "\n";
+    for (size_t i = 0; i < job.parts.size(); ++i) {
+        const Placement& placement = result.placements[i];
+        out << "place " << quotedName(job.parts[i].name) << " " << job.copies[i] << " " << placement.position.x << " "
+            << placement.position.y << " " << placement.rotation;
+        if (job.multiSheet) out << " " << result.sheets[i] + 1;
+        out << "\n";
+    }
+
+    std::ofstream file(path, std::ios::trunc);
+    file << out.str();
+    if (!file) {
+        error = path + ": cannot write";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef NESTBATCH_JOB_H
+#define NESTBATCH_JOB_H
+
+#include "annealer.h"
+#include "part.h"
+#include "sheetpacker.h"
+#include <string>
+#include <vector>
+
+// A nesting job read from a text file. One directive per line, '#' starts
+// a comment and names with spaces are double-quoted:
+//
+//   sheet WIDTH HEIGHT               optional; nests a strip of that height
+//   sheets WIDTH HEIGHT              optional; nests onto as few such sheets as possible
+//   rotations A B ...                allowed rotations in degrees
+//   part NAME QUANTITY X1 Y1 X2 Y2 ...  a polygon outline, three or more vertices
+//   shape NAME QUANTITY [SCALE]      one of the GUI's shapes, e.g. "Curve C"
+//   tolerance T                      curve flattening for later imports (default 0.1)
+//   import FILE [QUANTITY [SCALE]]   every closed outline in an SVG or DXF
+//                                    drawing, QUANTITY sets of them; FILE is
+//                                    relative to the job file
+//
+// Quantities expand into separate parts that share their cached NFPs.
+// Identical outlines in a drawing become copies of one part.
+struct Job
+{
+    std::string path;
+    std::vector<nest::Part> parts;
+    std::vector<int> copies;      // Which copy of its part line each part is, from 1
+    std::vector<double> rotations; // Empty keeps the placers' defaults
+    double sheetWidth = 0.0;      // 0 when no sheet is given
+    double sheetHeight = 0.0;
+    bool multiSheet = false;      // From sheets rather than sheet
+};
+
+// False with error set to "path:line: message" if the file cannot be read or parsed
+bool readJob(const std::string& path, Job& job, std::string& error);
+
+// A finished layout, moved so its bounding box starts at the origin. On
+// multiple sheets each placement is relative to its sheet instead.
+struct JobResult
+{
+    std::vector<nest::Placement> placements;
+    nest::Rect extent;
+    double utilization = 0.0;      // Part area over the layout's bounding box, per sheet summed
+    double sheetUtilization = 0.0; // Part area over the sheet, or the sheets used
+    bool fits = true;              // Whether the layout fits on the sheet, or every part on one
+    std::vector<int> sheets;       // Multiple sheets only: each part's, from 0, or -1
+    int sheetCount = 0;
+};
+
+JobResult finishJob(const Job& job, const nest::NestResult& result);
+JobResult finishJob(const Job& job, const nest::SheetsResult& result);
+
+// Writes the result one directive per line, in the same style as the job:
+//
+//   utilization U
+//   sheets N                         if the job has sheets: how many were used
+//   sheet_utilization U              if the job has a sheet or sheets
+//   fits yes|no                      if the job has a sheet or sheets
+//   extent WIDTH HEIGHT
+//   place NAME COPY X Y ROTATION [SHEET]  one per part, in input order
+//
+// A placement puts the part's local origin at (X, Y) after rotating it by
+// ROTATION degrees about that origin. With sheets, SHEET counts from 1 and
+// is 0 for a part too big for any; (X, Y) is relative to that sheet.
+bool writeResult(const std::string& path, const Job& job, const JobResult& result, std::string& error);
+
+#endif // NESTBATCH_JOB_H
@@ -0,0 +1,255 @@
+#include "bottomleftfill.h"
+#include "fixedpoint.h"
+#include "innerfit.h"
+#include "job.h"
+#include "nfpstore.h"
+#include "nfpwarmup.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace nest;
+
+struct Options
+{
+    std::string outputDir;      // Empty writes each result next to its job
+    int threads = 0;            // 0 uses one per hardware core
+    int chains = 4;             // Annealing chains, per sheet with sheets; not the core count, so seeds reproduce
+    double timeLimit = 0.0;     // Seconds per job, fill included; 0 is unlimited
+    uint64_t seed = 1;
+    bool quick = false;         // Bottom-left fill only
+    double coarse = 0.0;        // Outline simplification for the hot start of annealing; 0 is off
+    bool warmUp = false;        // Compute every NFP the job can need, on all cores, before placing
+};
+
+// Sets a stop flag once a time budget runs out, unless destroyed first
+class Watchdog
+{
+public:
+    Watchdog(std::atomic<bool>& stop, double seconds)
+    {
+        if (seconds <= 0) return;
+        thread = std::thread([this, &stop, seconds] {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!wake.wait_for(lock, std::chrono::duration<double>(seconds), [this] { return done; })) stop = true;
+        });
+    }
+
+    ~Watchdog()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        wake.notify_one();
+        if (thread.joinable()) thread.join();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool done = false;
+    std::thread thread;
+};
+
+static std::string resultPath(const std::string& jobPath, const Options& options)
+{
+    if (options.outputDir.empty()) return jobPath + ".out";
+    const size_t slash = jobPath.find_last_of('/');
+    return options.outputDir + "/" + (slash == std::string::npos ? jobPath : jobPath.substr(slash + 1)) + ".out";
+}
+
+// Fill, then anneal from the fill's layout, within the job's time budget;
+// with sheets, fill them one by one and anneal them all at once.
+// The calculator is shared by all jobs, so repeated parts hit its cache.
+static bool runJob(const std::string& path, const Options& options, nfpcalculator& nfpCalc, std::string& error)
+{
+    Job job;
+    if (!readJob(path, job, error)) return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<bool> stop{false};
+    Watchdog watchdog(stop, options.timeLimit);
+
+    // A sheet's height fixes the strip, which parts may not leave; its length
+    // is what gets minimized
+    const Objective objective = job.sheetHeight > 0 ? Objective::StripLength : Objective::BoundingArea;
+    FillConfig fillConfig;
+    if (!job.rotations.empty()) fillConfig.rotationAngles = job.rotations;
+    fillConfig.objective = objective;
+    fillConfig.stripHeight = job.sheetHeight;
+    if (job.sheetHeight > 0) fillConfig.sheet = stripRegion(job.sheetHeight);
+    AnnealConfig config;
+    if (!job.rotations.empty()) config.rotationAngles = job.rotations;
+    config.seed = options.seed;
+    config.coarseTolerance = options.coarse;
+    config.chains = options.chains;
+
+    if (options.warmUp) {
+        std::vector<double> rotations = fillConfig.rotationAngles;
+        if (!options.quick) rotations.insert(rotations.end(), config.rotationAngles.begin(), config.rotationAngles.end());
+        std::sort(rotations.begin(), rotations.end());
+        rotations.erase(std::unique(rotations.begin(), rotations.end()), rotations.end());
+        NfpWarmUp warmUp(job.parts, nfpCalc, rotations, options.threads);
+        warmUp.setStopFlag(&stop);
+        const size_t count = warmUp.run();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "%s: warmed up %zu NFPs in %.2f s\n", path.c_str(), count, seconds);
+    }
+
+    JobResult finished;
+    if (job.multiSheet) {
+        SheetsConfig sheetsConfig;
+        sheetsConfig.sheetWidth = job.sheetWidth;
+        sheetsConfig.sheetHeight = job.sheetHeight;
+        sheetsConfig.fill = fillConfig;
+        sheetsConfig.anneal = config;
+        sheetsConfig.annealSheets = !options.quick;
+        sheetsConfig.threads = options.threads;
+        SheetPacker packer(job.parts, nfpCalc, sheetsConfig);
+        packer.setStopFlag(&stop);
+        finished = finishJob(job, packer.run());
+    } else {
+        BottomLeftFill placer(job.parts, nfpCalc, fillConfig);
+        placer.setStopFlag(&stop);
+        NestResult result = placer.run();
+
+        if (!options.quick && !stop) {
+            config.objective = objective;
+            config.stripHeight = job.sheetHeight;
+            config.sheet = fillConfig.sheet;
+            config.threads = options.threads;
+            Annealer annealer(job.parts, nfpCalc, config);
+            annealer.setStopFlag(&stop);
+            result = annealer.run(result.placements);
+        }
+        finished = finishJob(job, result);
+    }
+
+    const std::string output = resultPath(path, options);
+    if (!writeResult(output, job, finished, error)) return false;
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%s: %zu parts, utilization %.1f%%", path.c_str(), job.parts.size(), finished.utilization * 100);
+    if (job.multiSheet) std::printf(", %d sheets", finished.sheetCount);
+    if (job.sheetWidth > 0) {
+        std::printf(", sheet %.1f%%, %s", finished.sheetUtilization * 100, finished.fits ? "fits" : "DOES NOT FIT");
+    }
+    std::printf(", %.2f s%s -> %s\n", seconds, stop ? " (time limit)" : "", output.c_str());
+    std::fflush(stdout);
+    return true;
+}
+
+static void usage()
+{
+    std::fprintf(stderr,
+                 "usage: nestbatch [options] JOB...\n"
+                 "  Nests each job file in turn, writing JOB.out with the placements and utilization.\n"
+                 "  --list FILE        also run the job files listed in FILE, one per line\n"
+                 "  --output-dir DIR   write results to DIR instead of next to each job\n"
+                 "  --threads N        annealing threads, shared out between sheets (default: one per core)\n"
+                 "  --chains N         annealing chains, per sheet; with --seed, the same N gives the\n"
+                 "                     same layout on any machine (default 4)\n"
+                 "  --time SECONDS     budget per job, fill included (default: none)\n"
+                 "  --seed N           random seed, for reproducible runs (default 1)\n"
+                 "  --quick            bottom-left fill only, no annealing\n"
+                 "  --coarse TOL       anneal the hot start on outlines simplified by up to TOL\n"
+                 "  --warm-up          compute all NFPs on all cores before placing each job\n"
+                 "  --cache-mb N       bound the in-memory NFP cache to N megabytes (default: unbounded)\n"
+                 "  --store FILE       NFP library to reuse and extend, as the GUI does\n"
+                 "  --grid RES         snap geometry to a RES grid and test overlaps exactly\n"
+                 "  See batch/job.h for the job file format.\n");
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    std::vector<std::string> jobs;
+    std::string storePath;
+    double cacheMegabytes = 0.0;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--quick") {
+            options.quick = true;
+        } else if (arg == "--output-dir" && hasValue) {
+            options.outputDir = argv[++i];
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        } else if (arg == "--chains" && hasValue) {
+            options.chains = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--time" && hasValue) {
+            options.timeLimit = std::atof(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--coarse" && hasValue) {
+            options.coarse = std::atof(argv[++i]);
+        } else if (arg == "--warm-up") {
+            options.warmUp = true;
+        } else if (arg == "--cache-mb" && hasValue) {
+            cacheMegabytes = std::atof(argv[++i]);
+        } else if (arg == "--store" && hasValue) {
+            storePath = argv[++i];
+        } else if (arg == "--grid" && hasValue) {
+            // Before any job is read: parts are snapped as they are made
+            setGridResolution(std::atof(argv[++i]));
+        } else if (arg == "--list" && hasValue) {
+            std::ifstream list(argv[++i]);
+            if (!list) {
+                std::fprintf(stderr, "%s: cannot open\n", argv[i]);
+                return 2;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line[0] != '#') jobs.push_back(line);
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            usage();
+            return 2;
+        } else {
+            jobs.push_back(arg);
+        }
+    }
+    if (jobs.empty()) {
+        usage();
+        return 2;
+    }
+
+    // One calculator for the whole batch: jobs sharing parts reuse their NFPs
+    nfpcalculator nfpCalc;
+    if (cacheMegabytes > 0) nfpCalc.setCacheBudget(size_t(cacheMegabytes * 1024 * 1024));
+    NfpStore store;
+    if (!storePath.empty()) {
+        if (store.open(storePath)) {
+            nfpCalc.setStore(&store);
+        } else {
+            std::fprintf(stderr, "%s: NFP store unavailable, NFPs will be computed on demand\n", storePath.c_str());
+        }
+    }
+
+    int failures = 0;
+    for (const std::string& path : jobs) {
+        std::string error;
+        if (!runJob(path, options, nfpCalc, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            ++failures;
+        }
+    }
+    if (jobs.size() > 1) {
+        std::printf("%zu jobs, %d failed, %zu NFPs cached\n", jobs.size(), failures, nfpCalc.cachedCount());
+    }
+    // For sizing --cache-mb: misses that follow evictions are recomputations
+    const NfpCacheStats cache = nfpCalc.cacheStats();
+    std::fprintf(stderr, "NFP cache: %llu hits, %llu misses, %llu evictions, %.1f MB in %zu entries\n",
+                 (unsigned long long)cache.hits, (unsigned long long)cache.misses, (unsigned long long)cache.evictions,
+                 cache.bytes / (1024.0 * 1024.0), cache.entries);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,11 @@
+#ifndef BENCH_ALLOCATIONS_H
+#define BENCH_ALLOCATIONS_H
+
+#include <cstdint>
+
+// Heap allocations made through the global operator new since the program
+// started, on any thread. allocations.cpp replaces the global operators, so
+// this counts everything the engine and the standard library allocate.
+uint64_t allocationCount();
+
+#endif // BENCH_ALLOCATIONS_H
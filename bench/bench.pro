@@ -0,0 +1,26 @@
+# Console benchmarks for the headless nesting engine. The engine needs no Qt
+# modules, but where QtGui is available the overlap kernel is also checked
+# against QPainterPath, the predicate the scene uses; CONFIG+=no_qtcheck
+# builds without it.
+TEMPLATE = app
+TARGET = nestbench
+CONFIG += console c++17 thread
+CONFIG -= app_bundle qt
+
+qtHaveModule(gui):!no_qtcheck {
+    CONFIG += qt
+    QT = core gui
+}
+
+include(../nest/nest.pri)
+
+SOURCES += \
+    allocations.cpp \
+    instances.cpp \
+    main.cpp \
+    report.cpp
+
+HEADERS += \
+    allocations.h \
+    instances.h \
+    report.h
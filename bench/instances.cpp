@@ -0,0 +1,41 @@
+#include "instances.h"
+#include "shapes.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace nest;
+
+Instance generateInstance(const InstanceSpec& spec)
+{
+    Instance instance;
+    instance.name = spec.name;
+    const std::vector<std::string>& names = shapeNames();
+    std::mt19937_64 rng(spec.seed);
+    std::uniform_int_distribution<size_t> pickShape(0, names.size() - 1);
+    std::uniform_int_distribution<size_t> pickScale(0, spec.scales.size() - 1);
+    for (size_t i = 0; i < spec.partCount; ++i) {
+        const std::string& name = names[pickShape(rng)];
+        const double scale = spec.scales[pickScale(rng)];
+        instance.parts.push_back(makePart(name, shapeOutline(name), scale));
+        instance.partArea += std::abs(signedArea(instance.parts.back().outline)) * scale * scale;
+    }
+    return instance;
+}
+
+std::vector<Placement> gridPlacements(const std::vector<Part>& parts)
+{
+    double cell = 0.0;
+    std::vector<Rect> bounds;
+    for (const Part& part : parts) {
+        bounds.push_back(boundingRect(transformed(part.outline, 0.0, part.scale)));
+        cell = std::max(cell, std::max(bounds.back().width(), bounds.back().height()));
+    }
+    const size_t columns = std::max<size_t>(1, size_t(std::ceil(std::sqrt(double(parts.size())))));
+    std::vector<Placement> placements(parts.size());
+    for (size_t i = 0; i < parts.size(); ++i) {
+        const Point corner{double(i % columns) * cell, double(i / columns) * cell};
+        placements[i].position = corner - Point{bounds[i].minX, bounds[i].minY};
+    }
+    return placements;
+}
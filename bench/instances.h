@@ -0,0 +1,32 @@
+#ifndef NESTBENCH_INSTANCES_H
+#define NESTBENCH_INSTANCES_H
+
+#include "part.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A reproducible nesting instance: parts drawn uniformly from the scene's
+// shapes, each at a scale drawn uniformly from scales
+struct InstanceSpec
+{
+    std::string name;
+    size_t partCount = 0;
+    std::vector<double> scales = {1.0};
+    uint64_t seed = 1;
+};
+
+struct Instance
+{
+    std::string name;
+    std::vector<nest::Part> parts;
+    double partArea = 0.0; // Sum of the scaled part areas
+};
+
+Instance generateInstance(const InstanceSpec& spec);
+
+// Parts at rotation 0 on a square grid of cells the size of the largest
+// part, so no two overlap
+std::vector<nest::Placement> gridPlacements(const std::vector<nest::Part>& parts);
+
+#endif // NESTBENCH_INSTANCES_H
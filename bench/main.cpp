@@ -0,0 +1,610 @@
+#include "allocations.h"
+#include "bottomleftfill.h"
+#include "collision.h"
+#include "fixedpoint.h"
+#include "geometry.h"
+#include "instances.h"
+#include "instrumentation.h"
+#include "minkowski.h"
+#include "nfp.h"
+#include "nfpwarmup.h"
+#include "partimport.h"
+#include "report.h"
+#include "shapes.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef QT_GUI_LIB
+#include <QPainterPath>
+#include <QPolygonF>
+#endif
+
+using namespace nest;
+
+static Polygon negated(const Polygon& poly)
+{
+    Polygon out;
+    for (const Point& p : poly) out.push_back(-p);
+    return out;
+}
+
+// Runs fn repeatedly for at least minSeconds and returns nanoseconds per call
+static double timePerCall(const std::function<void()>& fn, double minSeconds = 0.2)
+{
+    using Clock = std::chrono::steady_clock;
+    long iterations = 0;
+    const Clock::time_point start = Clock::now();
+    Clock::time_point now = start;
+    do {
+        for (int i = 0; i < 64; ++i) fn();
+        iterations += 64;
+        now = Clock::now();
+    } while (std::chrono::duration<double>(now - start).count() < minSeconds);
+    return std::chrono::duration<double, std::nano>(now - start).count() / iterations;
+}
+
+// Same vertex set up to start position and collinear points
+static bool sameConvex(const Polygon& a, const Polygon& b)
+{
+    const Polygon na = normalizedConvex(a);
+    const Polygon nb = normalizedConvex(b);
+    if (na.size() != nb.size()) return false;
+    for (size_t i = 0; i < na.size(); ++i) {
+        if (std::abs(na[i].x - nb[i].x) > 1e-6 || std::abs(na[i].y - nb[i].y) > 1e-6) return false;
+    }
+    return true;
+}
+
+static void benchMinkowski(const std::string& name, const Polygon& a, const Polygon& b)
+{
+    const Polygon negB = negated(b);
+    const bool convexA = isConvex(a);
+    const bool convexB = isConvex(negB);
+    // Non-convex inputs pay for their own hulls first, as nfpcalculator does
+    auto merge = [&] {
+        return minkowskiSumConvex(convexA ? a : convexHull(a), convexB ? negB : convexHull(negB));
+    };
+    volatile size_t sink = 0;
+
+    const double hullNs = timePerCall([&] { sink = sink + minkowskiSumHull(a, negB).size(); });
+    const double mergeNs = timePerCall([&] { sink = sink + merge().size(); });
+    const bool agree = sameConvex(minkowskiSumHull(a, negB), merge());
+
+    Record("minkowski", name)
+        .add("n", a.size())
+        .add("m", b.size())
+        .add("hull_ns", hullNs)
+        .add("merge_ns", mergeNs)
+        .add("speedup", hullNs / mergeNs)
+        .add("check", agree ? "agree" : "MISMATCH")
+        .print();
+}
+
+// One NFP of a non-convex pair computed from scratch, as on a cache miss:
+// decomposition, the convex sums and their union. The moving part is turned
+// so its pieces do not line up with the fixed part's.
+static void benchComputeNfp(const std::string& name, const Polygon& a, const Polygon& b)
+{
+    const Polygon moving = transformed(b, 30.0, 1.0, Point());
+    volatile size_t sink = 0;
+    const double ns = timePerCall([&] { sink = sink + computeNfp(a, moving).outer.size(); });
+    const Nfp nfp = computeNfp(a, moving);
+    size_t vertices = nfp.outer.size();
+    for (const Polygon& hole : nfp.holes) vertices += hole.size();
+
+    Record("nfp_pair", name)
+        .add("n", a.size())
+        .add("m", b.size())
+        .add("cold_ms", ns * 1e-6)
+        .add("holes", nfp.holes.size())
+        .add("vertices", vertices)
+        .print();
+}
+
+#ifdef QT_GUI_LIB
+// What QGraphicsItem::collidesWithItem ends up doing for two polygon items
+static bool qtOverlap(const Polygon& a, const Polygon& b)
+{
+    auto toPath = [](const Polygon& poly) {
+        QPolygonF qpoly;
+        for (const Point& p : poly) qpoly << QPointF(p.x, p.y);
+        QPainterPath path;
+        path.addPolygon(qpoly);
+        path.closeSubpath();
+        return path;
+    };
+    return toPath(a).intersects(toPath(b));
+}
+#endif
+
+// Random placements of b around a, roughly half of them overlapping. Positions
+// are continuous, so exact touching (where Qt reports a hit) does not come up.
+static void benchOverlap(const std::string& name, const Polygon& a, const Polygon& b)
+{
+    const int samples = 512;
+    std::mt19937_64 rng(12345);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const Rect boundsA = boundingRect(a);
+    const double reach = std::max(boundsA.width(), boundsA.height()) + std::max(boundingRect(b).width(), boundingRect(b).height());
+    std::vector<Polygon> placed;
+    std::vector<Rect> bounds;
+    for (int i = 0; i < samples; ++i) {
+        const Point offset = boundsA.center() + Point{(unit(rng) - 0.5) * reach, (unit(rng) - 0.5) * reach};
+        placed.push_back(transformed(b, 15.0 * int(unit(rng) * 24), 1.0, offset));
+        bounds.push_back(boundingRect(placed.back()));
+    }
+    const bool convexA = isConvex(a);
+    const bool convexB = isConvex(b);
+
+    int hits = 0;
+    int mismatches = 0;
+    int qtMismatches = 0;
+    for (int i = 0; i < samples; ++i) {
+        const bool fast = polygonsOverlap(CollisionShape{a, boundsA, convexA}, CollisionShape{placed[i], bounds[i], convexB});
+        hits += fast;
+        mismatches += fast != polygonsOverlapExhaustive(a, placed[i]);
+#ifdef QT_GUI_LIB
+        qtMismatches += fast != qtOverlap(a, placed[i]);
+#endif
+    }
+
+    volatile int sink = 0;
+    int next = 0;
+    const double exhaustiveNs = timePerCall([&] {
+        sink = sink + polygonsOverlapExhaustive(a, placed[next]);
+        next = (next + 1) % samples;
+    });
+    const double fastNs = timePerCall([&] {
+        sink = sink + polygonsOverlap(CollisionShape{a, boundsA, convexA}, CollisionShape{placed[next], bounds[next], convexB});
+        next = (next + 1) % samples;
+    });
+    Record record("overlap", name);
+    record.add("hits", hits)
+        .add("samples", samples)
+        .add("exhaustive_ns", exhaustiveNs)
+        .add("kernel_ns", fastNs)
+        .add("speedup", exhaustiveNs / fastNs)
+        .add("check", mismatches ? "MISMATCH" : "agree");
+#ifdef QT_GUI_LIB
+    const double qtNs = timePerCall([&] {
+        sink = sink + qtOverlap(a, placed[next]);
+        next = (next + 1) % samples;
+    });
+    record.add("qt_ns", qtNs).add("qt_check", qtMismatches ? "MISMATCH" : "agree");
+#else
+    (void)qtMismatches;
+    record.add("qt_check", "unavailable");
+#endif
+    record.print();
+}
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Cold NFPs between the instance's distinct parts, at the rotations the
+// placers use, then the same requests again from the warm cache
+static void benchNfp(const Instance& instance, uint64_t seed)
+{
+    std::vector<const Part*> kinds;
+    for (const Part& part : instance.parts) {
+        const bool known = std::any_of(kinds.begin(), kinds.end(), [&part](const Part* kind) {
+            return kind->hash == part.hash && kind->scale == part.scale;
+        });
+        if (!known) kinds.push_back(&part);
+    }
+    struct Request
+    {
+        const Part* fixed;
+        const Part* moving;
+        double movingRotation;
+    };
+    std::vector<Request> requests;
+    for (const Part* fixed : kinds) {
+        for (const Part* moving : kinds) {
+            for (double rotation : {0.0, 90.0, 180.0, 270.0}) requests.push_back({fixed, moving, rotation});
+        }
+    }
+    std::shuffle(requests.begin(), requests.end(), std::mt19937_64(seed));
+    requests.resize(std::min<size_t>(requests.size(), 500));
+
+    nfpcalculator calc;
+    volatile size_t sink = 0;
+    const Clock::time_point start = Clock::now();
+    for (const Request& r : requests) sink = sink + calc.getNFP(*r.fixed, *r.moving, 0.0, r.movingRotation).outer().size();
+    const double coldSeconds = secondsSince(start);
+    size_t next = 0;
+    const double warmNs = timePerCall([&] {
+        const Request& r = requests[next];
+        sink = sink + calc.getNFP(*r.fixed, *r.moving, 0.0, r.movingRotation).outer().size();
+        next = (next + 1) % requests.size();
+    });
+    const uint64_t allocationsBefore = allocationCount();
+    for (const Request& r : requests) sink = sink + calc.getNFP(*r.fixed, *r.moving, 0.0, r.movingRotation).outer().size();
+    const uint64_t cachedAllocations = allocationCount() - allocationsBefore;
+
+    Record("nfp", instance.name)
+        .add("parts", instance.parts.size())
+        .add("kinds", kinds.size())
+        .add("nfps", requests.size())
+        .add("cold_s", coldSeconds)
+        .add("nfps_per_s", requests.size() / coldSeconds)
+        .add("cached_ns", warmNs)
+        .add("cached_allocs", cachedAllocations)
+        .print();
+}
+
+// The whole NFP table an instance needs at the placers' rotations, computed
+// up front on one thread and then on all cores, each into a cold cache
+static void benchWarmUp(const Instance& instance)
+{
+    const std::vector<double> rotations = {0.0, 90.0, 180.0, 270.0};
+    const int threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    size_t count = 0;
+    double seconds[2];
+    for (int run = 0; run < 2; ++run) {
+        nfpcalculator calc;
+        NfpWarmUp warmUp(instance.parts, calc, rotations, run == 0 ? 1 : threads);
+        const Clock::time_point start = Clock::now();
+        count = warmUp.run();
+        seconds[run] = secondsSince(start);
+    }
+
+    Record("warmup", instance.name)
+        .add("parts", instance.parts.size())
+        .add("nfps", count)
+        .add("threads", threads)
+        .add("serial_s", seconds[0])
+        .add("parallel_s", seconds[1])
+        .add("speedup", seconds[0] / seconds[1])
+        .print();
+}
+
+// Trial placements against a full layout, as the annealer makes them:
+// place a part at a random point of the layout and test it
+static void benchLayoutOverlap(const Instance& instance, uint64_t seed)
+{
+    const PartTable table(instance.parts, {0, 90, 180, 270});
+    const Layout layout(table, gridPlacements(instance.parts));
+    Rect extent;
+    for (size_t i = 0; i < layout.size(); ++i) extent = extent.united(layout.bounds(i));
+
+    struct Query
+    {
+        size_t index;
+        size_t slot;
+        Point position;
+    };
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Query> queries;
+    for (int i = 0; i < 4096; ++i) {
+        const size_t index = std::uniform_int_distribution<size_t>(0, instance.parts.size() - 1)(rng);
+        const size_t slot = std::uniform_int_distribution<size_t>(0, table.rotationCount() - 1)(rng);
+        const Point target{extent.minX + unit(rng) * extent.width(), extent.minY + unit(rng) * extent.height()};
+        queries.push_back({index, slot, target - table.bounds(index, slot).center()});
+    }
+
+    Polygon outline;
+    int hits = 0;
+    for (const Query& q : queries) {
+        table.place(q.index, q.slot, q.position, outline);
+        hits += layout.overlaps(q.index, q.slot, outline, table.bounds(q.index, q.slot).translated(q.position));
+    }
+    volatile int sink = 0;
+    size_t next = 0;
+    const double queryNs = timePerCall([&] {
+        const Query& q = queries[next];
+        table.place(q.index, q.slot, q.position, outline);
+        sink = sink + layout.overlaps(q.index, q.slot, outline, table.bounds(q.index, q.slot).translated(q.position));
+        next = (next + 1) % queries.size();
+    });
+    // The buffers have grown by now, so further queries should not allocate
+    const uint64_t allocationsBefore = allocationCount();
+    for (const Query& q : queries) {
+        table.place(q.index, q.slot, q.position, outline);
+        sink = sink + layout.overlaps(q.index, q.slot, outline, table.bounds(q.index, q.slot).translated(q.position));
+    }
+    const uint64_t queryAllocations = allocationCount() - allocationsBefore;
+
+    Record("layout", instance.name)
+        .add("parts", instance.parts.size())
+        .add("hit_ratio", double(hits) / queries.size())
+        .add("query_ns", queryNs)
+        .add("queries_per_s", 1e9 / queryNs)
+        .add("allocs_per_query", double(queryAllocations) / queries.size())
+        .print();
+}
+
+// Scoring a moved box and applying the move, for each objective's cost
+static void benchCost(const Instance& instance, uint64_t seed)
+{
+    const std::vector<Placement> placements = gridPlacements(instance.parts);
+    std::vector<Rect> boxes;
+    Rect extent;
+    for (size_t i = 0; i < instance.parts.size(); ++i) {
+        boxes.push_back(boundingRect(placedOutline(instance.parts[i], placements[i])));
+        extent = extent.united(boxes.back());
+    }
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(-0.5, 0.5);
+    std::vector<std::pair<size_t, Rect>> moves;
+    for (int i = 0; i < 4096; ++i) {
+        const size_t index = std::uniform_int_distribution<size_t>(0, boxes.size() - 1)(rng);
+        moves.push_back({index, boxes[index].translated({unit(rng) * extent.width(), unit(rng) * extent.height()})});
+    }
+
+    const std::pair<Objective, const char*> objectives[] = {
+        {Objective::BoundingArea, "bounding_area"}, {Objective::StripLength, "strip_length"}, {Objective::Utilization, "utilization"}};
+    for (const auto& objective : objectives) {
+        CostModel model(objective.first, boxes, instance.partArea, extent.height());
+        volatile double sink = 0;
+        size_t next = 0;
+        const double costNs = timePerCall([&] {
+            sink = sink + model.costWith(moves[next].first, moves[next].second);
+            next = (next + 1) % moves.size();
+        });
+        const double moveNs = timePerCall([&] {
+            model.move(moves[next].first, moves[next].second);
+            next = (next + 1) % moves.size();
+        });
+        const uint64_t allocationsBefore = allocationCount();
+        for (const auto& move : moves) model.move(move.first, move.second);
+        const uint64_t moveAllocations = allocationCount() - allocationsBefore;
+        Record("cost", instance.name)
+            .add("parts", instance.parts.size())
+            .add("objective", objective.second)
+            .add("cost_with_ns", costNs)
+            .add("move_ns", moveNs)
+            .add("allocs_per_move", double(moveAllocations) / moves.size())
+            .print();
+    }
+}
+
+static double utilization(const Instance& instance, const std::vector<Placement>& placements)
+{
+    Rect extent;
+    for (size_t i = 0; i < instance.parts.size(); ++i) {
+        extent = extent.united(boundingRect(placedOutline(instance.parts[i], placements[i])));
+    }
+    return extent.area() > 0 ? instance.partArea / extent.area() : 0.0;
+}
+
+// Parts overlapping another; any nonzero count is a placer bug
+static int overlapCount(const Instance& instance, const std::vector<Placement>& placements)
+{
+    std::vector<double> rotations;
+    for (const Placement& placement : placements) rotations.push_back(placement.rotation);
+    const PartTable table(instance.parts, rotations);
+    const Layout layout(table, placements);
+    int count = 0;
+    for (size_t i = 0; i < layout.size(); ++i) count += layout.overlaps(i);
+    return count;
+}
+
+// Bottom-left fill, then a short fixed-seed anneal from its layout, both
+// with a cold NFP cache as on a first arrangement in the GUI. In
+// instrumented builds a non-empty profile prefix also gets the counters and
+// a Chrome trace of the run. coarse is the annealer's coarseTolerance.
+static void benchArrange(const Instance& instance, uint64_t seed, double coarse, const std::string& profile)
+{
+    instrumentation::reset();
+    instrumentation::setTracing(!profile.empty());
+    nfpcalculator calc;
+    Clock::time_point start = Clock::now();
+    BottomLeftFill placer(instance.parts, calc);
+    const NestResult fill = placer.run();
+    const double fillSeconds = secondsSince(start);
+
+    AnnealConfig config;
+    config.seed = seed;
+    config.iterationsPerTemp = 20;
+    config.coolingRate = 0.8;
+    config.coarseTolerance = coarse;
+    start = Clock::now();
+    Annealer annealer(instance.parts, calc, config);
+    const NestResult result = annealer.run(fill.placements);
+    const double annealSeconds = secondsSince(start);
+    const NfpCacheStats cache = calc.cacheStats();
+
+    // The same anneal again on the now warm cache. Less what setting up a
+    // run takes, measured with an empty schedule, it should not allocate.
+    AnnealConfig setupOnly = config;
+    setupOnly.initialTemperature = config.minTemperature;
+    uint64_t allocationsBefore = allocationCount();
+    Annealer(instance.parts, calc, setupOnly).run(fill.placements);
+    const uint64_t setupAllocations = allocationCount() - allocationsBefore;
+    allocationsBefore = allocationCount();
+    const NestResult warm = Annealer(instance.parts, calc, config).run(fill.placements);
+    const uint64_t warmAllocations = allocationCount() - allocationsBefore;
+    const double warmAllocationsPerMove =
+        warm.moves ? (double(warmAllocations) - double(setupAllocations)) / warm.moves : 0.0;
+
+    Record record("arrange", instance.name);
+    record.add("parts", instance.parts.size())
+        .add("fill_s", fillSeconds)
+        .add("fill_utilization", utilization(instance, fill.placements))
+        .add("coarse", coarse)
+        .add("anneal_s", annealSeconds)
+        .add("moves", result.moves)
+        .add("moves_per_s", result.moves / annealSeconds)
+        .add("warm_allocs_per_move", warmAllocationsPerMove)
+        .add("nfp_cache_mb", cache.bytes / (1024.0 * 1024.0))
+        .add("nfp_cache_entries", cache.entries)
+        .add("utilization", utilization(instance, result.placements))
+        .add("overlaps", overlapCount(instance, result.placements));
+    if (instrumentation::enabled()) {
+        const instrumentation::Snapshot stats = instrumentation::snapshot();
+        const double lookups = stats.counter(Counter::NfpCacheHit) + stats.counter(Counter::NfpCacheMiss);
+        record.add("nfp_hit_ratio", lookups ? stats.counter(Counter::NfpCacheHit) / lookups : 0.0)
+            .add("nfp_compute_s", stats.seconds(Timer::Nfp))
+            .add("fallback_rate", double(stats.counter(Counter::FallbackMove)) / std::max<uint64_t>(1, stats.counter(Counter::Move)))
+            .add("narrow_phase_tests", stats.counter(Counter::NarrowPhaseTest));
+        if (!profile.empty()) {
+            instrumentation::writeJson(profile + "-" + instance.name + ".json");
+            instrumentation::writeChromeTrace(profile + "-" + instance.name + ".trace.json");
+        }
+    }
+    instrumentation::setTracing(false);
+    record.print();
+}
+
+// A frame imported from SVG, its opening as a hole subpath, and a square
+// that fits the opening. The fill should put the square in the frame.
+static void benchFramedPart()
+{
+    std::istringstream svg("<svg xmlns=\"http://www.w3.org/2000/svg\">"
+                           "<path d=\"M0 0 H100 V100 H0 Z M20 20 V80 H80 V20 Z\"/>"
+                           "<rect x=\"200\" y=\"0\" width=\"50\" height=\"50\"/></svg>");
+    PartLibrary library;
+    std::string error;
+    Instance instance;
+    instance.name = "svg";
+    size_t holes = 0;
+    if (importSvg(svg, library, ImportOptions(), error)) {
+        for (size_t i = 0; i < library.size(); ++i) {
+            holes += library.entry(i).holeCount * size_t(library.entry(i).quantity);
+            for (int copy = 0; copy < library.entry(i).quantity; ++copy) instance.parts.push_back(library.part(i));
+        }
+    }
+    size_t enclosed = 0;
+    for (const Part& part : instance.parts) {
+        for (const Cavity& cavity : part.cavities) enclosed += cavity.enclosed;
+        instance.partArea += std::abs(signedArea(part.outline)) * part.scale * part.scale;
+    }
+
+    nfpcalculator calc;
+    const NestResult fill = BottomLeftFill(instance.parts, calc).run();
+    int nested = 0;
+    for (size_t i = 0; i < instance.parts.size(); ++i) {
+        const Part& frame = instance.parts[i];
+        const Placement& at = fill.placements[i];
+        for (const Polygon& hole : frame.holes) {
+            const Polygon placedHole = transformed(hole, at.rotation, frame.scale, at.position);
+            for (size_t j = 0; j < instance.parts.size(); ++j) {
+                if (j != i) nested += polygonWithin(placedOutline(instance.parts[j], fill.placements[j]), placedHole);
+            }
+        }
+    }
+    const bool ok = instance.parts.size() == 2 && holes == 1 && enclosed == 1 && nested == 1 &&
+                    overlapCount(instance, fill.placements) == 0;
+    Record("frame", instance.name)
+        .add("parts", instance.parts.size())
+        .add("holes", holes)
+        .add("enclosed_cavities", enclosed)
+        .add("nested", nested)
+        .add("overlaps", overlapCount(instance, fill.placements))
+        .add("check", ok ? "agree" : "MISMATCH")
+        .print();
+}
+
+static void microBenchmarks()
+{
+    const Polygon rectangle = shapeOutline("Rectangle");
+    const Polygon triangle = shapeOutline("Triangle");
+    const Polygon ellipse = shapeOutline("Ellipse");
+    const Polygon star = shapeOutline("Star");
+    const Polygon curveC = shapeOutline("Curve C");
+
+    benchMinkowski("rectangle/triangle", rectangle, triangle);
+    benchMinkowski("ellipse/ellipse", ellipse, ellipse);
+    benchMinkowski("star/ellipse", star, ellipse);
+    benchMinkowski("curveC/ellipse", curveC, ellipse);
+    benchMinkowski("curveC/curveC", curveC, curveC);
+
+    benchComputeNfp("star/curveC", star, curveC);
+    benchComputeNfp("curveC/ellipse", curveC, ellipse);
+    benchComputeNfp("curveC/curveC", curveC, curveC);
+
+    benchOverlap("rectangle/triangle", rectangle, triangle);
+    benchOverlap("ellipse/ellipse", ellipse, ellipse);
+    benchOverlap("star/ellipse", star, ellipse);
+    benchOverlap("curveC/ellipse", curveC, ellipse);
+    benchOverlap("curveC/curveC", curveC, curveC);
+
+    benchFramedPart();
+}
+
+static void usage()
+{
+    std::fprintf(stderr,
+                 "usage: nestbench [--json] [--seed N] [--sizes 10,100,1000] [--arrange-max N] [--no-micro]\n"
+                 "                 [--profile PREFIX] [--grid RES] [--coarse TOL]\n"
+                 "  Instances mix the scene's seven shapes; \"uniform\" ones are at scale 1,\n"
+                 "  \"mixed\" ones at scales 0.5 to 2. Arrangement runs only up to --arrange-max\n"
+                 "  parts (default 100). With --json each result is one JSON object per line.\n"
+                 "  In builds with CONFIG+=nest_instrument, --profile writes each arrangement's\n"
+                 "  counters to PREFIX-<instance>.json and its timeline to PREFIX-<instance>.trace.json.\n"
+                 "  --grid runs everything in fixed-point mode on a RES grid. --coarse anneals the\n"
+                 "  hot start on outlines simplified by up to TOL. Builds with QtGui also check the\n"
+                 "  overlap kernel against QPainterPath::intersects (qt_check).\n");
+}
+
+int main(int argc, char* argv[])
+{
+    uint64_t seed = 1;
+    std::vector<size_t> sizes = {10, 100, 1000};
+    size_t arrangeMax = 100;
+    double coarse = 0.0;
+    bool micro = true;
+    std::string profile;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--json") {
+            Record::setJson(true);
+        } else if (arg == "--no-micro") {
+            micro = false;
+        } else if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--profile" && hasValue) {
+            profile = argv[++i];
+        } else if (arg == "--grid" && hasValue) {
+            setGridResolution(std::atof(argv[++i]));
+        } else if (arg == "--coarse" && hasValue) {
+            coarse = std::atof(argv[++i]);
+        } else if (arg == "--arrange-max" && hasValue) {
+            arrangeMax = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--sizes" && hasValue) {
+            sizes.clear();
+            std::stringstream list(argv[++i]);
+            std::string size;
+            while (std::getline(list, size, ',')) sizes.push_back(std::strtoull(size.c_str(), nullptr, 10));
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    if (micro) microBenchmarks();
+
+    for (size_t size : sizes) {
+        if (size == 0) continue;
+        const InstanceSpec specs[] = {
+            {"uniform-" + std::to_string(size), size, {1.0}, hashCombine(seed, size)},
+            {"mixed-" + std::to_string(size), size, {0.5, 0.75, 1.0, 1.5, 2.0}, hashCombine(seed, size + 1)},
+        };
+        for (const InstanceSpec& spec : specs) {
+            const Instance instance = generateInstance(spec);
+            benchNfp(instance, spec.seed);
+            benchLayoutOverlap(instance, spec.seed);
+            benchCost(instance, spec.seed);
+            if (size <= arrangeMax) {
+                benchWarmUp(instance);
+                benchArrange(instance, spec.seed, coarse, profile);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include "report.h"
+#include <cstdio>
+
+static bool jsonOutput = false;
+
+static std::string quoted(const std::string& text)
+{
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+Record::Record(const std::string& bench, const std::string& name) : bench(bench), name(name)
+{
+}
+
+Record& Record::add(const std::string& key, double value)
+{
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.6g", value);
+    fields.push_back({key, text, false});
+    return *this;
+}
+
+Record& Record::add(const std::string& key, const std::string& value)
+{
+    fields.push_back({key, value, true});
+    return *this;
+}
+
+void Record::print() const
+{
+    if (jsonOutput) {
+        std::string line = "{\"bench\":" + quoted(bench) + ",\"name\":" + quoted(name);
+        for (const Field& field : fields) {
+            line += "," + quoted(field.key) + ":" + (field.quoted ? quoted(field.value) : field.value);
+        }
+        std::printf("%s}\n", line.c_str());
+    } else {
+        std::printf("%-9s %-20s", bench.c_str(), name.c_str());
+        for (const Field& field : fields) std::printf("  %s=%s", field.key.c_str(), field.value.c_str());
+        std::printf("\n");
+    }
+    std::fflush(stdout);
+}
+
+void Record::setJson(bool enabled)
+{
+    jsonOutput = enabled;
+}
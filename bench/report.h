@@ -0,0 +1,36 @@
+#ifndef NESTBENCH_REPORT_H
+#define NESTBENCH_REPORT_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// One benchmark measurement. Printed as aligned key=value text for reading,
+// or with --json as one JSON object per line, so runs of two builds can be
+// diffed or loaded into a spreadsheet.
+class Record
+{
+public:
+    Record(const std::string& bench, const std::string& name);
+
+    Record& add(const std::string& key, double value);
+    Record& add(const std::string& key, const std::string& value);
+
+    void print() const;
+
+    static void setJson(bool enabled);
+
+private:
+    struct Field
+    {
+        std::string key;
+        std::string value;
+        bool quoted;
+    };
+
+    std::string bench;
+    std::string name;
+    std::vector<Field> fields;
+};
+
+#endif // NESTBENCH_REPORT_H
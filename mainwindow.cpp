@@ -4,11 +4,19 @@
 #include <QPainter>
 #include <QList>
 #include <QtWidgets/qgraphicsitem.h>
-#include <QRandomGenerator>
-#include <cmath>
+#include <QStandardPaths>
+#include <QDir>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
+#include "annealer.h"
+#include "bottomleftfill.h"
+#include "partimport.h"
 
 MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), nfpCalc(nullptr)
+    : QMainWindow(parent), nfpCalc(new nest::nfpcalculator())
 {
     scene = new myscene(this);
     view = new QGraphicsView(scene);
@@ -46,14 +54,64 @@ MainWindow::MainWindow(QWidget *parent)
     leftLayout->addWidget(squareButton);
     leftLayout->addWidget(scaleSpinBox);
 
+    // Parts from SVG or DXF drawings, added to the scene below the current shapes
+    QPushButton *importButton = new QPushButton("Import Drawing...");
+    leftLayout->addWidget(importButton);
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::importDrawing);
+
 
     // Add Arrange Shapes button
-    QPushButton *arrangeButton = new QPushButton("Arrange Shapes");
+    arrangeButton = new QPushButton("Arrange Shapes");
     leftLayout->addWidget(arrangeButton);
     connect(arrangeButton, &QPushButton::clicked, this, &MainWindow::arrangeShapes);
 
+    // Arrangement limits: stop after a time budget or at a good enough utilization
+    timeLimitSpinBox = new QSpinBox;
+    timeLimitSpinBox->setRange(0, 3600);
+    timeLimitSpinBox->setPrefix("Time limit: ");
+    timeLimitSpinBox->setSuffix(" s");
+    timeLimitSpinBox->setSpecialValueText("No time limit");
+    leftLayout->addWidget(timeLimitSpinBox);
+
+    targetSpinBox = new QDoubleSpinBox;
+    targetSpinBox->setRange(0.0, 100.0);
+    targetSpinBox->setDecimals(0);
+    targetSpinBox->setPrefix("Good enough: ");
+    targetSpinBox->setSuffix(" %");
+    targetSpinBox->setSpecialValueText("No target");
+    leftLayout->addWidget(targetSpinBox);
+
+    // Ends the arrangement early; the best layout so far stays in the scene
+    stopButton = new QPushButton("Stop");
+    stopButton->setEnabled(false);
+    leftLayout->addWidget(stopButton);
+    connect(stopButton, &QPushButton::clicked, this, &MainWindow::stopArrangement);
+
+    progressBar = new QProgressBar;
+    progressBar->setRange(0, 100);
+    progressBar->setValue(0);
+    leftLayout->addWidget(progressBar);
+    statusLabel = new QLabel;
+    leftLayout->addWidget(statusLabel);
+
+    quickNestButton = new QPushButton("Quick Nest");
+    leftLayout->addWidget(quickNestButton);
+    connect(quickNestButton, &QPushButton::clicked, this, &MainWindow::quickNest);
+
+    // Results cross from the worker thread by queued connections
+    qRegisterMetaType<nest::NestResult>();
+
     connect(scaleSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &MainWindow::onScaleChanged);
     connect(scene, &QGraphicsScene::selectionChanged, this, &MainWindow::onSelectionChanged);
+    connect(scene, &myscene::cleared, this, &MainWindow::onSceneCleared);
+
+    // Reuse NFPs computed by earlier sessions; new ones are appended for the next
+    QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    if (QDir().mkpath(dataDir) && nfpStore.open(QDir(dataDir).filePath("nfp.store").toStdString())) {
+        nfpCalc->setStore(&nfpStore);
+    } else {
+        qDebug() << "NFP store unavailable, NFPs will be computed on demand";
+    }
 
     QHBoxLayout *mainLayout = new QHBoxLayout;
     mainLayout->addLayout(leftLayout);
@@ -64,6 +122,15 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    // The worker uses the NFP calculator, so it has to finish first
+    if (arrangeThread) {
+        *arrangeStop = true;
+        arrangeThread->quit();
+        arrangeThread->wait();
+        // Its deleteLater would need this thread's event loop, which no
+        // longer runs; the worker went with its own thread
+        delete arrangeThread;
+    }
     delete nfpCalc; // Clean up NFP calculator
     delete scene;
 }
@@ -93,7 +160,7 @@ void MainWindow::onScaleChanged(double value)
     }
 }
 
-void MainWindow::arrangeShapes()
+QList<QGraphicsPolygonItem*> MainWindow::movableShapes() const
 {
     // Collect all movable shapes as QGraphicsPolygonItem*
     QList<QGraphicsPolygonItem*> polygonShapes;
@@ -104,182 +171,210 @@ void MainWindow::arrangeShapes()
             }
         }
     }
+    return polygonShapes;
+}
+
+void MainWindow::applyResult(const QList<QGraphicsPolygonItem*>& shapes, const nest::NestResult& result)
+{
+    // Apply best arrangement: the only write to the scene. Shapes cleared
+    // while the optimizer ran are null.
+    for (int i = 0; i < shapes.size(); ++i) {
+        if (shapes[i]) {
+            applyPlacement(shapes[i], result.placements[i]);
+        }
+    }
+
+    // Update the scene to reflect the new positions and adjust scene rect if needed
+    QRectF totalRect = scene->itemsBoundingRect();
+    view->setSceneRect(totalRect.adjusted(-100, -100, 100, 100)); // Add padding
+    scene->update();
+}
 
+void MainWindow::quickNest()
+{
+    QList<QGraphicsPolygonItem*> polygonShapes = movableShapes();
     if (polygonShapes.isEmpty()) {
         qDebug() << "No movable shapes to arrange.";
         return;
     }
 
-    // Clean up previous NFP calculator instance
-    delete nfpCalc;
-    nfpCalc = new nfpcalculator(polygonShapes);
-
-    // Initial placement: first shape at origin, others unchanged
-    if (!polygonShapes.isEmpty()) {
-        polygonShapes[0]->setPos(0, 0);
-        polygonShapes[0]->setRotation(0);
+    std::vector<nest::Part> parts;
+    for (QGraphicsPolygonItem* shape : polygonShapes) {
+        parts.push_back(partFromItem(shape));
     }
 
-    // Store best arrangement
-    qreal bestCost = computeCost(polygonShapes);
-    QMap<QGraphicsItem*, QPointF> bestPositions;
-    QMap<QGraphicsItem*, qreal> bestRotations;
-    for (QGraphicsItem* shape : polygonShapes) {
-        bestPositions[shape] = shape->pos();
-        bestRotations[shape] = shape->rotation();
+    // Deterministic constructive nest, no annealing
+    nest::BottomLeftFill placer(parts, *nfpCalc);
+    applyResult(polygonShapes, placer.run());
+}
+
+void MainWindow::importDrawing()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Import Drawing", QString(), "Drawings (*.svg *.dxf)");
+    if (path.isEmpty()) return;
+
+    nest::PartLibrary library;
+    std::string error;
+    if (!nest::importFile(QFile::encodeName(path).toStdString(), library, nest::ImportOptions(), error)) {
+        QMessageBox::warning(this, "Import Drawing", QString::fromStdString(error));
+        return;
     }
 
-    // Simulated Annealing parameters (adjusted for more shapes)
-    qreal T = 200.0;            // Increased initial temperature for more exploration
-    qreal coolingRate = 0.95;   // Cooling rate
-    int iterationsPerTemp = 150; // Increased iterations for better optimization
-    qreal minT = 0.01;          // Stopping temperature
-    QList<qreal> rotationAngles = {0, 15, 30, 45, 60, 75, 90, 105, 120, 135, 150, 165,
-                                   180, 195, 210, 225, 240, 255, 270, 285, 300, 315, 330, 345};
-
-    // Main Simulated Annealing loop
-    while (T > minT) {
-        for (int iter = 0; iter < iterationsPerTemp; ++iter) {
-            // Skip the first shape (fixed at origin)
-            if (polygonShapes.size() <= 1) break;
-            int index = QRandomGenerator::global()->bounded(1, polygonShapes.size());
-            QGraphicsPolygonItem* shape = polygonShapes[index];
-
-            // Save current state
-            QPointF oldPos = shape->pos();
-            qreal oldRotation = shape->rotation();
-
-            // Generate trial position using NFPs
-            bool validPosition = false;
-            QPointF newPos;
-            qreal newRotation = rotationAngles[QRandomGenerator::global()->bounded(rotationAngles.size())];
-
-            // Try placing near a random existing shape
-            int anchorIdx = QRandomGenerator::global()->bounded(polygonShapes.size());
-            QGraphicsPolygonItem* anchorShape = polygonShapes[anchorIdx];
-            if (anchorShape && anchorShape != shape) {
-                // Check if we should try placing in a hole
-                bool tryHolePlacement = (anchorShape->data(0).toString() == "ShapeWithHole") &&
-                                        nfpCalc->canFitInHole(anchorShape, shape, anchorShape->rotation(), newRotation);
-
-                if (tryHolePlacement) {
-                    // Get the hole rectangle
-                    QRectF holeRect = nfpCalc->getInnerRect(anchorShape);
-
-                    // Transform hole to scene coordinates
-                    QTransform holeTransform;
-                    holeTransform.rotate(anchorShape->rotation());
-                    holeTransform.scale(anchorShape->scale(), anchorShape->scale());
-                    QRectF sceneHoleRect = holeTransform.mapRect(holeRect);
-                    sceneHoleRect.translate(anchorShape->pos());
-
-                    // Try to position the shape inside the hole with random offsets
-                    int holeAttempts = 15;
-                    while (holeAttempts-- > 0 && !validPosition) {
-                        // Calculate position within the hole with small random offset
-                        qreal offsetX = QRandomGenerator::global()->generateDouble() * (sceneHoleRect.width() * 0.8) -
-                                        (sceneHoleRect.width() * 0.4);
-                        qreal offsetY = QRandomGenerator::global()->generateDouble() * (sceneHoleRect.height() * 0.8) -
-                                        (sceneHoleRect.height() *
-                                         0.4);
-                        newPos = sceneHoleRect.center() + QPointF(offsetX, offsetY);
-
-                        shape->setPos(newPos);
-                        shape->setRotation(newRotation);
-
-                        if (!hasOverlaps(shape, polygonShapes)) {
-                            validPosition = true;
-                            qDebug() << "Successfully placed shape inside a hole!";
-                        }
-                    }
-                }
-
-                // If hole placement failed or wasn't attempted, try normal NFP placement
-                if (!validPosition) {
-                    QPolygonF nfp = nfpCalc->getNFP(anchorShape, shape, anchorShape->rotation(), newRotation);
-                    // Adjust sampling range based on number of shapes
-                    qreal samplingRange = 100.0 + (polygonShapes.size() * 20.0); // Dynamic range
-                    QRectF nfpBounds = nfp.boundingRect();
-                    int attempts = 20 + (polygonShapes.size() * 2); // Dynamic attempts
-                    while (attempts-- > 0 && !validPosition) {
-                        qreal offsetX = QRandomGenerator::global()->generateDouble() * samplingRange - (samplingRange / 2.0);
-                        qreal offsetY = QRandomGenerator::global()->generateDouble() * samplingRange - (samplingRange / 2.0);
-                        QPointF candidate = nfpBounds.center() + QPointF(offsetX, offsetY);
-                        if (nfp.containsPoint(candidate, Qt::OddEvenFill)) { // Outside NFP
-                            newPos = anchorShape->pos() + candidate;
-                            shape->setPos(newPos);
-                            shape->setRotation(newRotation);
-                            // Use hasOverlaps for precise collision detection
-                            if (!hasOverlaps(shape, polygonShapes)) {
-                                validPosition = true;
-                            } else {
-                                qDebug() << "NFP positioning overlap detected at" << newPos;
-                            }
-                        }
-                    }
-                }
+    // Lay the copies out in rows under whatever is already in the scene
+    const QRectF existing = scene->itemsBoundingRect();
+    const qreal left = existing.isEmpty() ? 0 : existing.left();
+    const qreal rowWidth = qMax<qreal>(existing.width(), 1000);
+    const qreal gap = 10;
+    qreal x = left;
+    qreal y = existing.isEmpty() ? 0 : existing.bottom() + gap;
+    qreal rowHeight = 0;
+    for (size_t i = 0; i < library.size(); ++i) {
+        QPolygonF outline;
+        const nest::Point* vertices = library.vertices(i);
+        for (size_t v = 0; v < library.entry(i).count; ++v) {
+            outline << QPointF(vertices[v].x, vertices[v].y);
+        }
+        const QRectF bounds = outline.boundingRect();
+        for (int copy = 0; copy < library.entry(i).quantity; ++copy) {
+            if (x > left && x + bounds.width() > left + rowWidth) {
+                x = left;
+                y += rowHeight + gap;
+                rowHeight = 0;
             }
+            QGraphicsPolygonItem *item = new QGraphicsPolygonItem(outline);
+            item->setBrush(QBrush(Qt::lightGray));
+            item->setPos(x, y);
+            item->setFlag(QGraphicsItem::ItemIsMovable, true);
+            item->setFlag(QGraphicsItem::ItemIsSelectable, true);
+            scene->addItem(item);
+            x += bounds.width() + gap;
+            rowHeight = qMax(rowHeight, bounds.height());
+        }
+    }
 
-            // Fallback to random perturbation if NFP fails
-            if (!validPosition) {
-                qreal perturbationRange = 50.0 + (polygonShapes.size() * 10.0); // Dynamic range
-                int fallbackAttempts = 30 + (polygonShapes.size() * 2); // Dynamic attempts
-                while (fallbackAttempts-- > 0 && !validPosition) {
-                    newPos = oldPos + QPointF(QRandomGenerator::global()->generateDouble() * perturbationRange - (perturbationRange / 2.0),
-                                              QRandomGenerator::global()->generateDouble() * perturbationRange - (perturbationRange / 2.0));
-                    shape->setPos(newPos);
-                    shape->setRotation(newRotation);
-                    if (!hasOverlaps(shape, polygonShapes)) {
-                        validPosition = true;
-                    } else {
-                        qDebug() << "Fallback positioning overlap detected at" << newPos;
-                    }
-                }
-            }
+    view->setSceneRect(scene->itemsBoundingRect().adjusted(-100, -100, 100, 100));
+    statusLabel->setText(QString("Imported %1 parts, %2 distinct").arg(library.partCount()).arg(library.size()));
+}
 
-            if (validPosition) {
-                qreal newCost = computeCost(polygonShapes);
-                qreal deltaCost = newCost - bestCost;
-
-                // Metropolis criterion
-                if (deltaCost < 0 || QRandomGenerator::global()->generateDouble() < exp(-deltaCost / T)) {
-                    // Accept the move
-                    bestCost = newCost;
-                    bestPositions[shape] = newPos;
-                    bestRotations[shape] = newRotation;
-                } else {
-                    // Revert
-                    shape->setPos(oldPos);
-                    shape->setRotation(oldRotation);
-                }
-            } else {
-                // Revert if invalid
-                shape->setPos(oldPos);
-                shape->setRotation(oldRotation);
-                qDebug() << "Could not find a valid position for shape after attempts";
+void MainWindow::arrangeShapes()
+{
+    if (arrangeThread) return; // One arrangement at a time
+
+    QList<QGraphicsPolygonItem*> polygonShapes = movableShapes();
+    if (polygonShapes.isEmpty()) {
+        qDebug() << "No movable shapes to arrange.";
+        return;
+    }
+
+    // Snapshot the scene into plain engine types; the optimizer never touches the items
+    std::vector<nest::Part> parts;
+    for (QGraphicsPolygonItem* shape : polygonShapes) {
+        parts.push_back(partFromItem(shape));
+    }
+
+    // The NFP cache is keyed by geometry, so it is kept across runs and scene edits
+    nest::AnnealConfig config;
+    // A fixed chain count, as in nestbatch: it decides how the work and the
+    // random streams are split, so it must not follow the core count
+    config.chains = 4;
+    config.threads = QThread::idealThreadCount();
+    config.targetUtilization = targetSpinBox->value() / 100.0;
+
+    arrangingShapes = polygonShapes;
+    arrangeThread = new QThread(this);
+    arrangeStop = std::make_shared<std::atomic<bool>>(false);
+    ArrangeWorker *worker = new ArrangeWorker(std::move(parts), nfpCalc, config, arrangeStop);
+    worker->moveToThread(arrangeThread);
+    connect(arrangeThread, &QThread::started, worker, &ArrangeWorker::run);
+    connect(worker, &ArrangeWorker::progress, this, &MainWindow::onArrangeProgress, Qt::QueuedConnection);
+    connect(worker, &ArrangeWorker::finished, this, &MainWindow::onArrangeFinished, Qt::QueuedConnection);
+    connect(worker, &ArrangeWorker::finished, arrangeThread, &QThread::quit);
+    connect(arrangeThread, &QThread::finished, worker, &QObject::deleteLater);
+    connect(arrangeThread, &QThread::finished, arrangeThread, &QObject::deleteLater);
+
+    // The budget covers the fill as well as the annealing, so it is kept here
+    // rather than in the annealer's own time limit
+    budgetExpired = false;
+    const int run = ++arrangeRun;
+    if (timeLimitSpinBox->value() > 0) {
+        QTimer::singleShot(timeLimitSpinBox->value() * 1000, this, [this, run]() {
+            if (arrangeStop && arrangeRun == run) {
+                budgetExpired = true;
+                *arrangeStop = true;
             }
-        }
-        // Cool down
-        T *= coolingRate;
+        });
     }
 
-    // Apply best arrangement
-    for (QGraphicsItem* shape : polygonShapes) {
-        shape->setPos(bestPositions[shape]);
-        shape->setRotation(bestRotations[shape]);
+    arrangeButton->setEnabled(false);
+    quickNestButton->setEnabled(false);
+    stopButton->setEnabled(true);
+    progressBar->setValue(0);
+    statusLabel->setText("Arranging...");
+    arrangeThread->start();
+}
+
+void MainWindow::stopArrangement()
+{
+    if (arrangeStop) {
+        *arrangeStop = true;
+        statusLabel->setText("Stopping...");
     }
-    // Update the scene to reflect the new positions and adjust scene rect if needed
-    QRectF totalRect = scene->itemsBoundingRect();
-    view->setSceneRect(totalRect.adjusted(-100, -100, 100, 100)); // Add padding
-    scene->update();
 }
 
-// Compute the cost: area of the bounding rectangle with
-qreal MainWindow::computeCost(const QList<QGraphicsPolygonItem*>& shapes) {
-    if (shapes.isEmpty()) return 0;
-    QRectF totalRect = shapes.first()->sceneBoundingRect();
-    for (int i = 1; i < shapes.size(); ++i) {
-        totalRect = totalRect.united(shapes[i]->sceneBoundingRect());
+void MainWindow::onSceneCleared()
+{
+    // The items are gone, and new ones may reuse their addresses: drop them
+    // by index and stop, as there is nothing left to arrange
+    if (!arrangeStop) return;
+    arrangingShapes.fill(nullptr);
+    *arrangeStop = true;
+}
+
+void MainWindow::onArrangeProgress(const nest::NestResult& best, double utilization, double fraction)
+{
+    applyResult(arrangingShapes, best);
+    progressBar->setValue(int(fraction * 100));
+    statusLabel->setText(QString("Best so far: %1% utilization").arg(utilization * 100, 0, 'f', 1));
+}
+
+void MainWindow::onArrangeFinished(const nest::NestResult& result, double utilization, bool cancelled)
+{
+    applyResult(arrangingShapes, result);
+    arrangingShapes.clear();
+    arrangeThread = nullptr; // It and the worker delete themselves once the thread has stopped
+    arrangeStop.reset();
+
+    const QString summary = QString("%1% utilization").arg(utilization * 100, 0, 'f', 1);
+    if (budgetExpired) {
+        statusLabel->setText("Time limit reached: " + summary);
+    } else if (cancelled) {
+        statusLabel->setText("Stopped: " + summary);
+    } else {
+        progressBar->setValue(100);
+        statusLabel->setText("Done: " + summary);
     }
-    return totalRect.width() * totalRect.height();
+    arrangeButton->setEnabled(true);
+    quickNestButton->setEnabled(true);
+    stopButton->setEnabled(false);
+}
+
+nest::Part MainWindow::partFromItem(QGraphicsPolygonItem* item)
+{
+    nest::Polygon outline;
+    for (const QPointF& p : item->polygon()) {
+        outline.push_back({p.x(), p.y()});
+    }
+    // Cavities are detected from the outline itself
+    return nest::makePart(std::string(), outline, item->scale());
+}
+
+// The engine places R(s * p) at its position. An item maps a local point p to
+// pos + o + R(s * (p - o)), o being the transform origin, so matching the two
+// takes pos = enginePos - o + R(s * o).
+void MainWindow::applyPlacement(QGraphicsPolygonItem* item, const nest::Placement& placement)
+{
+    const QPointF o = item->transformOriginPoint();
+    const nest::Point shift = nest::rotated({o.x() * item->scale(), o.y() * item->scale()}, placement.rotation);
+    item->setRotation(placement.rotation);
+    item->setPos(placement.position.x - o.x() + shift.x, placement.position.y - o.y() + shift.y);
 }
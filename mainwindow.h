@@ -14,8 +14,17 @@
 #include <QApplication>
 #include <QPoint>
 #include <QDoubleSpinBox>
+#include <QSpinBox>
+#include <QLabel>
+#include <QProgressBar>
+#include <QThread>
+#include "annealer.h"
+#include "arrangeworker.h"
 #include "nfpcalculator.h"
+#include "nfpstore.h"
+#include "part.h"
 #include <QGraphicsItem>
+#include <QGraphicsPolygonItem>
 #include <QList>
 
 QT_BEGIN_NAMESPACE
@@ -62,27 +71,41 @@ protected:
     void onSelectionChanged();
     void onScaleChanged(double value);
     void arrangeShapes();
+    void stopArrangement();
+    void quickNest();
+    void importDrawing();
+    void onArrangeProgress(const nest::NestResult& best, double utilization, double fraction);
+    void onArrangeFinished(const nest::NestResult& result, double utilization, bool cancelled);
+    void onSceneCleared();
 
-    // Template function to check for overlaps between shapes
-    template <typename T>
-    bool hasOverlaps(QGraphicsItem* shape, const QList<T*>& others) {
-        for (T* other : others) {
-            if (other != shape && shape->collidesWithItem(other)) {
-                return true;
-            }
-        }
-        return false;
-    }
-
-    // Declare computeCost as a member function
-    qreal computeCost(const QList<QGraphicsPolygonItem*>& shapes);
+    // Conversion between scene items and the headless nesting engine
+    static nest::Part partFromItem(QGraphicsPolygonItem* item);
+    static void applyPlacement(QGraphicsPolygonItem* item, const nest::Placement& placement);
+    QList<QGraphicsPolygonItem*> movableShapes() const;
+    void applyResult(const QList<QGraphicsPolygonItem*>& shapes, const nest::NestResult& result);
 
 private:
     QDoubleSpinBox *scaleSpinBox;
     QGraphicsItem *selectedItem;
     myscene *scene;
     QGraphicsView *view;
-    nfpcalculator *nfpCalc; // Pointer to NFP calculator
+    nest::nfpcalculator *nfpCalc; // Pointer to NFP calculator
+    nest::NfpStore nfpStore;      // On-disk NFP library shared between runs
+
+    // Arrangement in progress, if any. The worker reports on arrangingShapes,
+    // the items it was given; those deleted since are null and skipped.
+    QPushButton *arrangeButton;
+    QPushButton *quickNestButton;
+    QPushButton *stopButton;
+    QSpinBox *timeLimitSpinBox;
+    QDoubleSpinBox *targetSpinBox;
+    QProgressBar *progressBar;
+    QLabel *statusLabel;
+    QThread *arrangeThread = nullptr;
+    std::shared_ptr<std::atomic<bool>> arrangeStop; // Set while running; the worker itself is never touched
+    QList<QGraphicsPolygonItem*> arrangingShapes;
+    int arrangeRun = 0;
+    bool budgetExpired = false;
 };
 
 #endif // MAINWINDOW_H
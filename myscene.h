@@ -8,6 +8,9 @@ class myscene : public QGraphicsScene{
 
 public:
     myscene(QObject *parent = nullptr);
+signals:
+    // Every item was deleted by dropping Clear on the scene
+    void cleared();
 protected:
     void dragEnterEvent(QGraphicsSceneDragDropEvent *event) override;
     void dragMoveEvent(QGraphicsSceneDragDropEvent *event) override;
@@ -0,0 +1,354 @@
+#include "annealer.h"
+#include "fixedpoint.h"
+#include "instrumentation.h"
+#include "simplify.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace nest {
+
+double computeCost(const std::vector<Part>& parts, const std::vector<Placement>& placements)
+{
+    Rect totalRect;
+    for (size_t i = 0; i < parts.size(); ++i) {
+        totalRect = totalRect.united(boundingRect(placedOutline(parts[i], placements[i])));
+    }
+    return totalRect.width() * totalRect.height();
+}
+
+// Uniformly random point on the NFP boundary, holes included. Every such point
+// is a touching position against the anchor, so no sampling is wasted inside it.
+template <typename Rng>
+static Point sampleBoundary(const NfpView& nfp, Rng& rng)
+{
+    double perimeter = 0.0;
+    auto forEachEdge = [&nfp](auto&& fn) {
+        auto walk = [&fn](const LoopView& loop) {
+            for (size_t i = 0; i < loop.size(); ++i) fn(loop[i], loop[(i + 1) % loop.size()]);
+        };
+        walk(nfp.outer());
+        for (size_t h = 0; h < nfp.holeCount(); ++h) walk(nfp.hole(h));
+    };
+    forEachEdge([&perimeter](const Point& a, const Point& b) { perimeter += std::hypot(b.x - a.x, b.y - a.y); });
+
+    double target = std::uniform_real_distribution<double>(0.0, perimeter)(rng);
+    Point result = nfp.outer().front();
+    bool found = false;
+    forEachEdge([&](const Point& a, const Point& b) {
+        if (found) return;
+        const double length = std::hypot(b.x - a.x, b.y - a.y);
+        if (target <= length && length > 0) {
+            result = a + (b - a) * (target / length);
+            found = true;
+        }
+        target -= length;
+    });
+    return result;
+}
+
+Annealer::Annealer(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const AnnealConfig& config)
+    : parts(parts), nfpCalc(nfpCalc), config(config)
+{
+}
+
+// Metropolis moves at temperature T on one chain
+void Annealer::anneal(Chain& chain, double T, int iterations)
+{
+    NEST_TEMPERATURE_SCOPE(T);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    auto bounded = [&chain](size_t lo, size_t hi) { // [lo, hi)
+        return std::uniform_int_distribution<size_t>(lo, hi - 1)(chain.rng);
+    };
+    const size_t n = parts.size();
+    Polygon& trialOutline = chain.trialOutline;
+    // Coarse or full resolution outlines, for the whole step
+    const std::vector<Part>& shapes = coarse ? coarseParts : parts;
+    const PartTable& outlines = coarse ? coarseTable : table;
+
+    for (int iter = 0; iter < iterations; ++iter) {
+        // Skip the first shape (fixed in place)
+        if (n <= 1 || stopRequested()) break;
+        ++chain.moves;
+        NEST_COUNT(Move);
+        const size_t index = bounded(1, n);
+        const Part& shape = shapes[index];
+        const Placement old = chain.current.placement(index);
+
+        // Generate trial position using NFPs
+        bool validPosition = false;
+        Placement trial;
+        Rect trialBox;
+        const std::vector<size_t>& slots = partSlots[index];
+        const size_t slot = slots[bounded(0, slots.size())];
+        trial.rotation = outlines.rotation(slot);
+        const Rect fit = onSheet[index] ? innerFitRect(config.sheet, outlines.bounds(index, slot)) : Rect();
+        auto tryPosition = [&](const Point& position) {
+            trial.position = snapped(position);
+            if (onSheet[index] && !clampInto(fit, trial.position)) return false;
+            outlines.place(index, slot, trial.position, trialOutline);
+            trialBox = outlines.bounds(index, slot).translated(trial.position);
+            return !chain.current.overlaps(index, slot, trialOutline, trialBox);
+        };
+
+        // Try placing near a random existing shape
+        const size_t anchorIdx = bounded(0, n);
+        const Part& anchorShape = shapes[anchorIdx];
+        const Placement& anchor = chain.current.placement(anchorIdx);
+        if (anchorIdx != index) {
+            // Check if we should try placing in a cavity. Cavities are sorted by
+            // area, so only the leading ones can take this part; the box test is a
+            // cheap necessary condition and the IFP holds every position that fits.
+            const size_t anchorSlot = chain.current.slot(anchorIdx);
+            const Rect& smallBounds = outlines.bounds(index, slot);
+            const size_t cavities = outlines.cavitiesAtLeast(anchorIdx, outlines.area(index, slot));
+            for (size_t c = 0; c < cavities && !validPosition; ++c) {
+                const Rect& cavityBounds = outlines.cavityBounds(anchorIdx, anchorSlot, c);
+                if (smallBounds.width() > cavityBounds.width() || smallBounds.height() > cavityBounds.height()) continue;
+
+                // Deterministic candidates: each region's corners, then its centroid.
+                // Only parts already sitting in the cavity can reject them.
+                NEST_COUNT(HoleAttempt);
+                const InnerFit& ifp = nfpCalc.getIFP(anchorShape, c, shape, anchor.rotation, trial.rotation);
+                const Point origin = anchor.position + ifpOffset(shape, trial.rotation);
+                for (size_t r = 0; r < ifp.regions.size() && !validPosition; ++r) {
+                    const Polygon& region = ifp.regions[r];
+                    Point centroid;
+                    for (size_t v = 0; v < region.size() && !validPosition; ++v) {
+                        validPosition = tryPosition(origin + region[v]);
+                        centroid = centroid + region[v] * (1.0 / region.size());
+                    }
+                    if (!validPosition && region.size() > 2) validPosition = tryPosition(origin + centroid);
+                }
+                if (validPosition) NEST_COUNT(HoleSuccess);
+            }
+
+            // If cavity placement failed or wasn't attempted, slide along the anchor's NFP.
+            // Boundary points touch the anchor by construction; the overlap check
+            // only has to confirm the other parts are clear.
+            if (!validPosition) {
+                const NfpView nfp = nfpCalc.getNFP(anchorShape, shape, anchor.rotation, trial.rotation);
+                const Point origin = anchor.position + nfpOffset(anchorShape, shape, anchor.rotation, trial.rotation);
+                int attempts = nfp.isEmpty() ? 0 : 20 + int(n * 2);
+                while (attempts-- > 0 && !validPosition) {
+                    validPosition = tryPosition(origin + sampleBoundary(nfp, chain.rng));
+                }
+            }
+        }
+
+        // Fallback to random perturbation if NFP fails
+        if (!validPosition) {
+            NEST_COUNT(FallbackMove);
+            const double perturbationRange = 50.0 + (n * 10.0);
+            int fallbackAttempts = 30 + int(n * 2);
+            while (fallbackAttempts-- > 0 && !validPosition) {
+                Point position = old.position + Point{unit(chain.rng) * perturbationRange - (perturbationRange / 2.0),
+                                                      unit(chain.rng) * perturbationRange - (perturbationRange / 2.0)};
+                if (onSheet[index] && !fit.isEmpty()) {
+                    position.x = std::min(fit.maxX, std::max(fit.minX, position.x));
+                    position.y = std::min(fit.maxY, std::max(fit.minY, position.y));
+                }
+                validPosition = tryPosition(position);
+            }
+        }
+
+        if (validPosition) {
+            // Scored from the box alone; nothing changes unless the move is accepted
+            const double newCost = chain.costModel.costWith(index, trialBox);
+            const double deltaCost = newCost - chain.cost;
+
+            // Metropolis criterion
+            if (deltaCost < 0 || unit(chain.rng) < std::exp(-deltaCost / T)) {
+                chain.current.move(index, trial, trialOutline);
+                chain.costModel.move(index, trialBox);
+                chain.cost = newCost;
+                NEST_COUNT(AcceptedMove);
+            }
+        }
+    }
+}
+
+NestResult Annealer::run(const std::vector<Placement>& initial)
+{
+    if (parts.empty()) return NestResult();
+    NEST_TIME_SCOPE(Anneal);
+    deadline = std::chrono::steady_clock::now() +
+               std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(config.timeLimit));
+
+    // Every rotation a chain can reach, rotated and scaled once up front
+    std::vector<double> rotations = config.rotationAngles;
+    for (const Placement& placement : initial) rotations.push_back(placement.rotation);
+    table = PartTable(parts, rotations);
+    rotationSlots.clear();
+    for (double angle : config.rotationAngles) rotationSlots.push_back(table.slot(angle));
+    if (rotationSlots.empty()) rotationSlots.push_back(table.slot(0.0));
+    partSlots.resize(parts.size());
+    onSheet.assign(parts.size(), 0);
+    for (size_t i = 0; i < parts.size(); ++i) {
+        partSlots[i] = table.distinctSlots(parts[i], rotationSlots);
+        if (config.sheet.isEmpty()) continue;
+        // Only rotations that fit the sheet, unless none do
+        std::vector<size_t> fitting;
+        for (size_t slot : partSlots[i]) {
+            if (!innerFitRect(config.sheet, table.bounds(i, slot)).isEmpty()) fitting.push_back(slot);
+        }
+        if (fitting.empty()) continue;
+        partSlots[i] = std::move(fitting);
+        onSheet[i] = 1;
+    }
+
+    // Coarse outlines contain the real ones, so a layout valid for them is
+    // valid, and an initial layout valid for the real ones stays so: moves
+    // only ever test the moved part
+    coarse = config.coarseTolerance > 0 && config.coarseFraction > 0;
+    coarseParts.clear();
+    coarseTable = PartTable();
+    if (coarse) {
+        for (const Part& part : parts) coarseParts.push_back(simplifiedPart(part, config.coarseTolerance));
+        coarseTable = PartTable(coarseParts, rotations);
+    }
+
+    double partArea = 0.0;
+    for (size_t i = 0; i < parts.size(); ++i) partArea += table.area(i, 0);
+    auto setUp = [&](Chain& chain, const std::vector<Placement>& placements) {
+        chain.current = Layout(coarse ? coarseTable : table, placements);
+        std::vector<Rect> boxes(parts.size());
+        for (size_t i = 0; i < parts.size(); ++i) boxes[i] = chain.current.bounds(i);
+        chain.costModel = CostModel(config.objective, boxes, partArea, config.stripHeight);
+        chain.cost = chain.costModel.cost();
+    };
+
+    const int chainCount = std::max(1, config.chains);
+    const uint64_t seed = config.seed ? config.seed : std::random_device{}();
+    std::vector<Chain> chains(chainCount);
+    for (int k = 0; k < chainCount; ++k) {
+        // Independent, reproducible stream per chain
+        chains[k].rng.seed(hashCombine(seed, uint64_t(k)));
+        setUp(chains[k], initial);
+        chains[k].temperatureScale = config.replicaExchange ? std::pow(config.temperatureLadder, k) : 1.0;
+    }
+
+    // The per-temperature budget is shared out, so N chains do the same total work in 1/N the time
+    const int iterations = std::max(1, (config.iterationsPerTemp + chainCount - 1) / chainCount);
+    // Epochs end in an exchange and a check on the best layout; a lone chain only does the check
+    const int epochLength = std::max(1, config.exchangeInterval);
+    std::unique_ptr<ThreadPool> pool;
+    if (chainCount > 1) {
+        const int threads = config.threads > 0 ? config.threads : int(std::thread::hardware_concurrency());
+        pool.reset(new ThreadPool(std::min(chainCount, threads)));
+    }
+
+    std::mt19937_64 exchangeRng(hashCombine(seed, uint64_t(chainCount)));
+    double T = config.initialTemperature;
+    // Cost per unit of area: 1 - P / A changes by P / A² per unit of A
+    double costUnit = 1.0;
+    if (config.objective == Objective::Utilization) {
+        const double area = chains[0].costModel.extent().area();
+        if (area > 0 && partArea > 0) costUnit = partArea / (area * area);
+    }
+
+    // The best layout any chain has held at the end of an epoch, the
+    // initial one included. True once it is good enough to stop.
+    NestResult best;
+    best.cost = std::numeric_limits<double>::infinity();
+    const double schedule = std::log(config.minTemperature / config.initialTemperature);
+    auto keepBest = [&] {
+        const Chain& leader = *std::min_element(chains.begin(), chains.end(),
+                                                [](const Chain& a, const Chain& b) { return a.cost < b.cost; });
+        if (leader.cost >= best.cost) return false;
+        best.placements = leader.current.placements();
+        best.cost = leader.cost;
+        if (progress) {
+            progress(best, schedule < 0 ? std::min(1.0, std::log(T / config.initialTemperature) / schedule) : 1.0);
+        }
+        const double extent = leader.costModel.extent().area();
+        return config.targetUtilization > 0 && extent > 0 && partArea / extent >= config.targetUtilization;
+    };
+    bool goodEnough = keepBest();
+
+    // Coarse boxes overstate costs, so the chains and the best layout are
+    // rescored on the real outlines
+    auto refine = [&] {
+        coarse = false;
+        for (Chain& chain : chains) setUp(chain, chain.current.placements());
+        Chain scored;
+        setUp(scored, best.placements);
+        best.cost = scored.cost;
+    };
+
+    // Main Simulated Annealing loop, in epochs separated by exchanges
+    while (!goodEnough && T > config.minTemperature && !stopRequested()) {
+        if (coarse && schedule < 0 && std::log(T / config.initialTemperature) / schedule >= config.coarseFraction) {
+            refine();
+            goodEnough = keepBest();
+            if (goodEnough) break;
+        }
+        int steps = 0;
+        double epochT = T;
+        while (steps < epochLength && epochT > config.minTemperature) {
+            epochT *= config.coolingRate;
+            ++steps;
+        }
+        auto runChain = [&](size_t k) {
+            double chainT = T;
+            for (int s = 0; s < steps; ++s) {
+                anneal(chains[k], chainT * chains[k].temperatureScale * costUnit, iterations);
+                chainT *= config.coolingRate; // Cool down
+            }
+        };
+        if (pool) {
+            pool->parallelFor(chains.size(), runChain);
+        } else {
+            runChain(0);
+        }
+        T = epochT;
+        if (chainCount > 1) exchange(chains, T * costUnit, exchangeRng);
+        goodEnough = keepBest();
+    }
+
+    if (coarse) refine();
+    for (const Chain& chain : chains) best.moves += chain.moves;
+    return best;
+}
+
+bool Annealer::stopRequested() const
+{
+    if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return true;
+    return config.timeLimit > 0 && std::chrono::steady_clock::now() >= deadline;
+}
+
+void Annealer::exchange(std::vector<Chain>& chains, double T, std::mt19937_64& rng)
+{
+    NEST_TIME_SCOPE(Exchange);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    if (config.replicaExchange) {
+        // Swap neighbouring replicas with the usual acceptance probability
+        for (size_t k = 0; k + 1 < chains.size(); ++k) {
+            Chain& cold = chains[k];
+            Chain& hot = chains[k + 1];
+            const double betaCold = 1.0 / (T * cold.temperatureScale);
+            const double betaHot = 1.0 / (T * hot.temperatureScale);
+            const double delta = (betaCold - betaHot) * (cold.cost - hot.cost);
+            if (delta >= 0 || unit(rng) < std::exp(delta)) {
+                std::swap(cold.current, hot.current);
+                std::swap(cold.costModel, hot.costModel);
+                std::swap(cold.cost, hot.cost);
+            }
+        }
+        return;
+    }
+
+    // Independent chains: the worst restarts from the best
+    auto byCost = [](const Chain& a, const Chain& b) { return a.cost < b.cost; };
+    const auto best = std::min_element(chains.begin(), chains.end(), byCost);
+    const auto worst = std::max_element(chains.begin(), chains.end(), byCost);
+    if (best != worst) {
+        worst->current = best->current;
+        worst->costModel = best->costModel;
+        worst->cost = best->cost;
+    }
+}
+
+} // namespace nest
@@ -0,0 +1,132 @@
+#ifndef NEST_ANNEALER_H
+#define NEST_ANNEALER_H
+
+#include "costmodel.h"
+#include "layout.h"
+#include "nfpcalculator.h"
+#include "parttable.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace nest {
+
+struct AnnealConfig
+{
+    double initialTemperature = 200.0; // High initial temperature for more exploration
+    double coolingRate = 0.95;
+    int iterationsPerTemp = 150;
+    double minTemperature = 0.01;      // Stopping temperature
+    std::vector<double> rotationAngles = {0, 15, 30, 45, 60, 75, 90, 105, 120, 135, 150, 165,
+                                          180, 195, 210, 225, 240, 255, 270, 285, 300, 315, 330, 345};
+    uint64_t seed = 0;                 // 0 picks a random seed
+
+    // Temperatures above are in units of area for every objective. Costs in
+    // other units, Utilization's fraction, are converted at the initial
+    // layout: a change in the fraction counts as the area change that causes it there.
+    Objective objective = Objective::BoundingArea;
+    double stripHeight = 0.0;          // Objective::StripLength only
+    // Region every part must lie in: a sheet, or stripRegion() for a strip.
+    // Empty, the default, leaves the layout unbounded. Parts that fit the
+    // region at none of the rotations are left free.
+    Rect sheet;
+
+    // Ending the schedule early: once the best layout's utilization (part
+    // area over its bounding box area) reaches targetUtilization, or after
+    // timeLimit seconds. 0 disables either.
+    double targetUtilization = 0.0;
+    double timeLimit = 0.0;
+
+    // Parallel annealing. With chains > 1 the per-temperature iteration budget
+    // is split across the chains, which run on a thread pool and exchange
+    // states every exchangeInterval temperature steps.
+    int chains = 1;
+    int threads = 0;                   // 0 uses one per hardware core
+    int exchangeInterval = 5;
+    // false: independent chains, the worst restarts from the best at each exchange.
+    // true: parallel tempering, chain k runs at T * temperatureLadder^k and
+    // neighbours swap states with the Metropolis replica-exchange rule.
+    bool replicaExchange = false;
+    double temperatureLadder = 1.5;
+
+    // Level of detail. With coarseTolerance > 0 the hot start of the
+    // schedule, up to coarseFraction of it, moves parts by outlines
+    // simplified outward by that much (see simplify.h): fewer vertices in
+    // every NFP and overlap test, and layouts that stay valid for the real
+    // outlines. The rest of the schedule runs at full resolution.
+    double coarseTolerance = 0.0;
+    double coarseFraction = 0.5;
+};
+
+struct NestResult
+{
+    std::vector<Placement> placements; // One per part, same order as the input
+    double cost = 0.0;
+    long moves = 0;                    // Trial moves made, summed over chains
+    std::vector<size_t> unplaced;      // Fill only: parts that fit nowhere on its sheet
+};
+
+// Cost: area of the bounding rectangle of all placed parts
+double computeCost(const std::vector<Part>& parts, const std::vector<Placement>& placements);
+
+// Simulated annealing over part positions and rotations. Works entirely on
+// plain polygons; nothing is written back to the caller until run() returns.
+// The nfpcalculator may be shared with other threads.
+class Annealer
+{
+public:
+    Annealer(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const AnnealConfig& config = AnnealConfig());
+
+    // Anneal from initial, e.g. a BottomLeftFill layout. Part 0 stays where
+    // initial puts it; the others move around it.
+    NestResult run(const std::vector<Placement>& initial);
+
+    // Called on run()'s thread whenever the best layout so far improves, at
+    // most once per exchangeInterval temperature steps, with the fraction of
+    // the cooling schedule done
+    using ProgressCallback = std::function<void(const NestResult& best, double fraction)>;
+    void setProgressCallback(ProgressCallback callback) { progress = std::move(callback); }
+
+    // Another thread may set this flag to end run() early with the best
+    // layout so far. Not owned.
+    void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+
+private:
+    // One Markov chain: its own random stream and placement state
+    struct Chain
+    {
+        std::mt19937_64 rng;
+        Layout current;
+        CostModel costModel;
+        double cost = 0.0;
+        double temperatureScale = 1.0;
+        long moves = 0;
+        Polygon trialOutline; // Trial placements go here; swapped with the layout's on acceptance
+    };
+
+    void anneal(Chain& chain, double T, int iterations);
+    void exchange(std::vector<Chain>& chains, double T, std::mt19937_64& rng);
+    bool stopRequested() const;
+
+    const std::vector<Part>& parts;
+    nfpcalculator& nfpCalc;
+    AnnealConfig config;
+    PartTable table;                  // Built by run() for the allowed and initial rotations
+    std::vector<Part> coarseParts;    // Simplified parts, when config.coarseTolerance > 0
+    PartTable coarseTable;
+    bool coarse = false;              // Chains are on the coarse outlines
+    std::vector<size_t> rotationSlots; // Table slots of config.rotationAngles
+    // Per part, the rotationSlots that give it distinct outlines: moves draw from these
+    std::vector<std::vector<size_t>> partSlots;
+    std::vector<char> onSheet; // Per part: whether moves must keep it on config.sheet
+    ProgressCallback progress;
+    const std::atomic<bool>* stopFlag = nullptr;
+    std::chrono::steady_clock::time_point deadline; // Set by run() when config.timeLimit > 0
+};
+
+} // namespace nest
+
+#endif // NEST_ANNEALER_H
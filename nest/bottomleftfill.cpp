@@ -0,0 +1,357 @@
+#include "bottomleftfill.h"
+#include "fixedpoint.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <numeric>
+
+namespace nest {
+
+namespace {
+
+// An NFP edge in scene coordinates, tagged with the NFP it came from
+struct Edge
+{
+    Point p1, p2;
+    double minX, maxX, minY, maxY;
+    size_t source;
+};
+
+} // namespace
+
+// Further than this inside an NFP is an overlap beyond what the exact test
+// lets pass as touching
+static const double kInsideMargin = 1e-6;
+
+// 1 inside the loop, -1 outside, 0 within margin of its boundary
+static int side(const LoopView& loop, const Point& p, double margin)
+{
+    bool inside = false;
+    const size_t n = loop.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const Point& a = loop[j];
+        const Point& b = loop[i];
+        const Point d = b - a;
+        const double len2 = d.x * d.x + d.y * d.y;
+        const double t = len2 > 0 ? std::clamp(((p.x - a.x) * d.x + (p.y - a.y) * d.y) / len2, 0.0, 1.0) : 0.0;
+        const Point q = a + d * t;
+        if ((p.x - q.x) * (p.x - q.x) + (p.y - q.y) * (p.y - q.y) <= margin * margin) return 0;
+        if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * d.x / d.y) inside = !inside;
+    }
+    return inside ? 1 : -1;
+}
+
+// Clearly inside the NFP: the moving part would overlap the fixed one
+static bool insideNfp(const NfpView& nfp, const Point& p)
+{
+    if (side(nfp.outer(), p, kInsideMargin) != 1) return false;
+    for (size_t h = 0; h < nfp.holeCount(); ++h) {
+        if (side(nfp.hole(h), p, kInsideMargin) != -1) return false;
+    }
+    return true;
+}
+
+// Proper intersections between edges of different NFPs, by sort and sweep
+// along x, with the two NFPs each lies on
+static void edgeIntersections(std::vector<Edge>& edges, std::vector<Point>& out,
+                              std::vector<std::pair<size_t, size_t>>& sources)
+{
+    std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) { return a.minX < b.minX; });
+    thread_local std::vector<size_t> active;
+    active.clear();
+    for (size_t i = 0; i < edges.size(); ++i) {
+        const Edge& e = edges[i];
+        active.erase(std::remove_if(active.begin(), active.end(), [&](size_t k) { return edges[k].maxX < e.minX; }),
+                     active.end());
+        for (size_t k : active) {
+            const Edge& f = edges[k];
+            if (f.source == e.source || f.minY > e.maxY || e.minY > f.maxY) continue;
+            const Point r = e.p2 - e.p1;
+            const Point s = f.p2 - f.p1;
+            const double denom = r.x * s.y - r.y * s.x;
+            if (denom == 0.0) continue;
+            const Point qp = f.p1 - e.p1;
+            const double t = (qp.x * s.y - qp.y * s.x) / denom;
+            const double u = (qp.x * r.y - qp.y * r.x) / denom;
+            if (t > 0 && t < 1 && u > 0 && u < 1) {
+                out.push_back(e.p1 + r * t);
+                sources.push_back({e.source, f.source});
+            }
+        }
+        active.push_back(i);
+    }
+}
+
+BottomLeftFill::BottomLeftFill(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const FillConfig& config)
+    : parts(parts), nfpCalc(nfpCalc), config(config)
+{
+}
+
+void BottomLeftFill::collectCandidates(size_t index, size_t slot, const Rect& fit, const Layout& layout,
+                                       std::vector<Point>& candidates, std::vector<Sources>& sources)
+{
+    const Part& moving = parts[index];
+    const double rotation = table.rotation(slot);
+    const Rect& bounds = table.bounds(index, slot);
+    const size_t kindSlot = kinds[index] * table.rotationCount() + slot;
+    const size_t none = parts.size();
+    // Kept between calls, like the callers' candidate buffers
+    thread_local std::vector<Edge> edges;
+    edges.clear();
+    for (size_t j = 0; j < parts.size(); ++j) {
+        nfpBoxes[j] = Rect();
+        if (j == index || !layout.isPlaced(j)) continue;
+        const Placement& fixed = layout.placement(j);
+
+        // Touching positions around the placed part all put the two boxes
+        // in contact; on a sheet, none of them may lie in the fit
+        const Rect& box = layout.bounds(j);
+        const Rect reach{box.minX - bounds.maxX, box.minY - bounds.maxY, box.maxX - bounds.minX, box.maxY - bounds.minY};
+        if (!fit.isEmpty() && (reach.maxX < fit.minX - kInsideMargin || reach.minX > fit.maxX + kInsideMargin ||
+                               reach.maxY < fit.minY - kInsideMargin || reach.minY > fit.maxY + kInsideMargin)) {
+            continue;
+        }
+
+        nfps[j] = nfpCalc.getNFP(parts[j], moving, fixed.rotation, rotation);
+        nfpOrigins[j] = fixed.position + nfpOffset(parts[j], moving, fixed.rotation, rotation);
+        nfpBoxes[j] = reach;
+        // A buried NFP still rules out its inside in filterCandidates() but
+        // gives no candidates
+        if (!buried[j * kindSlots + kindSlot]) {
+            const Point& origin = nfpOrigins[j];
+            auto addLoop = [&](const LoopView& loop) {
+                for (size_t v = 0; v < loop.size(); ++v) {
+                    const Point a = origin + loop[v];
+                    const Point b = origin + loop[(v + 1) % loop.size()];
+                    candidates.push_back(a);
+                    sources.push_back({j, none});
+                    edges.push_back({a, b, std::min(a.x, b.x), std::max(a.x, b.x), std::min(a.y, b.y), std::max(a.y, b.y), j});
+                }
+            };
+            addLoop(nfps[j].outer());
+            for (size_t h = 0; h < nfps[j].holeCount(); ++h) addLoop(nfps[j].hole(h));
+        }
+
+        // Snug positions inside its cavities. A hole is off the NFP's
+        // boundary, so these count even when the NFP is buried.
+        const size_t cavities = table.cavitiesAtLeast(j, table.area(index, slot));
+        const Point inside = fixed.position + ifpOffset(moving, rotation);
+        for (size_t c = 0; c < cavities; ++c) {
+            for (const Polygon& region : nfpCalc.getIFP(parts[j], c, moving, fixed.rotation, rotation).regions) {
+                for (const Point& p : region) {
+                    candidates.push_back(inside + p);
+                    sources.push_back({none, none});
+                }
+            }
+        }
+    }
+
+    if (!fit.isEmpty()) {
+        // The inner-fit rectangle's edges cross the NFPs like another NFP's
+        // would. Infinite sides are cut to the candidates' span, or for the
+        // first part to its box at the origin.
+        const Rect span = candidates.empty() ? Rect{-bounds.minX, -bounds.minY, -bounds.minX, -bounds.minY}
+                                             : boundingRect(candidates);
+        const Rect window{std::isfinite(fit.minX) ? fit.minX : span.minX, std::isfinite(fit.minY) ? fit.minY : span.minY,
+                          std::isfinite(fit.maxX) ? fit.maxX : span.maxX, std::isfinite(fit.maxY) ? fit.maxY : span.maxY};
+        const Point corners[] = {{window.minX, window.minY}, {window.maxX, window.minY},
+                                 {window.maxX, window.maxY}, {window.minX, window.maxY}};
+        for (int c = 0; c < 4; ++c) {
+            const Point& a = corners[c];
+            const Point& b = corners[(c + 1) % 4];
+            candidates.push_back(a);
+            sources.push_back({none, none});
+            edges.push_back({a, b, std::min(a.x, b.x), std::max(a.x, b.x), std::min(a.y, b.y), std::max(a.y, b.y), none});
+        }
+    }
+    edgeIntersections(edges, candidates, sources);
+    if (gridEnabled()) {
+        for (Point& p : candidates) p = snapped(p);
+    }
+}
+
+void BottomLeftFill::filterCandidates(size_t index, size_t slot, const Rect& fit, const Layout& layout,
+                                      std::vector<Point>& candidates, std::vector<Sources>& sources)
+{
+    // Per placed part: whether its NFP still has a candidate that may fit
+    thread_local std::vector<char> live;
+    live.assign(parts.size() + 1, 0);
+
+    // Off the sheet, or clearly inside the NFP of a part whose box the
+    // moving one meets there, is no place for it. A part with holes is left
+    // to the exact test: its NFP covers its holes too. Neighbouring
+    // candidates tend to lie in the same NFP, so the last one found is tried
+    // first.
+    const Rect& bounds = table.bounds(index, slot);
+    auto rules = [&](size_t j, const Point& p) {
+        return nfpBoxes[j].contains(p) && table.holeCount(j) == 0 && insideNfp(nfps[j], p - nfpOrigins[j]);
+    };
+    size_t last = parts.size();
+    size_t kept = 0;
+    for (size_t c = 0; c < candidates.size(); ++c) {
+        Point p = candidates[c];
+        if (!fit.isEmpty() && !clampInto(fit, p)) continue;
+        bool inside = last < parts.size() && rules(last, p);
+        if (!inside) {
+            layout.query(bounds.translated(p), [&](int j) {
+                if (inside || size_t(j) == last || !rules(size_t(j), p)) return;
+                inside = true;
+                last = size_t(j);
+            });
+        }
+        if (inside) continue;
+        live[std::min(sources[c].first, parts.size())] = 1;
+        live[std::min(sources[c].second, parts.size())] = 1;
+        candidates[kept] = p;
+        sources[kept] = sources[c];
+        ++kept;
+    }
+    candidates.resize(kept);
+    sources.resize(kept);
+
+    // An NFP none of whose candidates survived is covered all along: between
+    // two candidates its boundary crosses no other NFP, so it lies wholly
+    // inside one or wholly off the sheet. Placed parts stay put, so later
+    // parts of this kind at this rotation skip it.
+    const size_t kindSlot = kinds[index] * table.rotationCount() + slot;
+    for (size_t j = 0; j < parts.size(); ++j) {
+        if (nfpBoxes[j].isEmpty() || live[j] || nfps[j].isEmpty()) continue;
+        buried[j * kindSlots + kindSlot] = 1;
+    }
+}
+
+NestResult BottomLeftFill::run()
+{
+    const size_t n = parts.size();
+    if (n == 0) return NestResult();
+    NEST_TIME_SCOPE(Fill);
+
+    std::vector<double> rotations = config.rotationAngles;
+    rotations.push_back(0.0);
+    table = PartTable(parts, rotations);
+    std::vector<size_t> rotationSlots;
+    for (double angle : config.rotationAngles) rotationSlots.push_back(table.slot(angle));
+    if (rotationSlots.empty()) rotationSlots.push_back(table.slot(0.0));
+    std::vector<std::vector<size_t>> partSlots(n);
+    for (size_t i = 0; i < n; ++i) partSlots[i] = table.distinctSlots(parts[i], rotationSlots);
+
+    std::map<std::pair<uint64_t, double>, size_t> kindIds;
+    kinds.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        kinds[i] = kindIds.emplace(std::make_pair(parts[i].hash, parts[i].scale), kindIds.size()).first->second;
+    }
+    kindSlots = kindIds.size() * table.rotationCount();
+    buried.assign(n * kindSlots, 0);
+    nfps.assign(n, NfpView());
+    nfpOrigins.assign(n, Point());
+    nfpBoxes.assign(n, Rect());
+
+    // Largest first; equal areas keep their input order
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t a, size_t b) { return table.area(a, 0) > table.area(b, 0); });
+
+    double partArea = 0.0;
+    for (size_t i = 0; i < n; ++i) partArea += table.area(i, 0);
+    std::vector<Placement> placements(n);
+    for (Placement& placement : placements) placement.rotation = table.rotation(rotationSlots.front());
+    Layout layout(table, placements);
+    for (size_t i = 0; i < n; ++i) layout.unplace(i);
+    CostModel costModel(config.objective, std::vector<Rect>(n), partArea, config.stripHeight);
+
+    struct Scored
+    {
+        double cost;
+        Point position;
+        bool operator<(const Scored& other) const
+        {
+            if (cost != other.cost) return cost < other.cost;
+            if (position.y != other.position.y) return position.y < other.position.y;
+            return position.x < other.position.x;
+        }
+    };
+    std::vector<Point> candidates;
+    std::vector<Sources> sources;
+    std::vector<Scored> scored;
+    Polygon outline;
+
+    const bool bounded = !config.sheet.isEmpty();
+    std::vector<size_t> unplaced;
+    double outsideX = 0.0; // Right edge of the parts left off the sheet
+    for (size_t k = 0; k < n; ++k) {
+        const size_t index = order[k];
+        if (k == 0 && !bounded) {
+            layout.move(index, placements[index]);
+            costModel.move(index, layout.bounds(index));
+            continue;
+        }
+
+        bool found = false;
+        Scored best{0.0, Point()};
+        size_t bestSlot = rotationSlots.front();
+        const bool stopping = stopFlag && stopFlag->load(std::memory_order_relaxed);
+        for (size_t slot : partSlots[index]) {
+            if (stopping) break;
+            const Rect fit = bounded ? innerFitRect(config.sheet, table.bounds(index, slot)) : Rect();
+            if (bounded && fit.isEmpty()) continue;
+            candidates.clear();
+            sources.clear();
+            collectCandidates(index, slot, fit, layout, candidates, sources);
+            NEST_COUNT_N(FillCandidate, candidates.size());
+            filterCandidates(index, slot, fit, layout, candidates, sources);
+            scored.clear();
+            for (const Point& p : candidates) {
+                scored.push_back({costModel.costWith(index, table.bounds(index, slot).translated(p)), p});
+            }
+            std::sort(scored.begin(), scored.end());
+
+            // Cheapest first, so the first overlap-free candidate is this rotation's best
+            for (const Scored& candidate : scored) {
+                if (found && !(candidate < best)) break;
+                table.place(index, slot, candidate.position, outline);
+                if (layout.overlaps(index, slot, outline, table.bounds(index, slot).translated(candidate.position))) continue;
+                best = candidate;
+                bestSlot = slot;
+                found = true;
+                break;
+            }
+        }
+
+        Placement placement;
+        placement.rotation = table.rotation(bestSlot);
+        if (found) {
+            placement.position = best.position;
+        } else if (bounded) {
+            // Off the sheet, in a row right of it and of the parts already there
+            const Rect& bounds = table.bounds(index, bestSlot);
+            const Rect extent = costModel.extent();
+            double right = std::max(outsideX, extent.isEmpty() ? 0.0 : extent.maxX);
+            if (std::isfinite(config.sheet.maxX)) right = std::max(right, config.sheet.maxX);
+            const double bottom = std::isfinite(config.sheet.minY) ? config.sheet.minY : 0.0;
+            placement.position = snapped({right - bounds.minX, bottom - bounds.minY});
+            outsideX = placement.position.x + bounds.maxX;
+            placements[index] = placement;
+            unplaced.push_back(index);
+            continue;
+        } else {
+            // Nothing touching was free: continue right of everything
+            const Rect extent = costModel.extent();
+            const Rect& bounds = table.bounds(index, bestSlot);
+            placement.position = snapped({extent.maxX - bounds.minX, extent.minY - bounds.minY});
+        }
+        layout.move(index, placement);
+        costModel.move(index, layout.bounds(index));
+    }
+
+    NestResult result;
+    result.placements = layout.placements();
+    result.cost = costModel.cost();
+    std::sort(unplaced.begin(), unplaced.end());
+    for (size_t index : unplaced) result.placements[index] = placements[index];
+    result.unplaced = std::move(unplaced);
+    return result;
+}
+
+} // namespace nest
@@ -0,0 +1,77 @@
+#ifndef NEST_BOTTOMLEFTFILL_H
+#define NEST_BOTTOMLEFTFILL_H
+
+#include "annealer.h"
+#include "parttable.h"
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace nest {
+
+struct FillConfig
+{
+    std::vector<double> rotationAngles = {0, 90, 180, 270};
+    Objective objective = Objective::BoundingArea;
+    double stripHeight = 0.0; // Objective::StripLength only
+    // Region every part must lie in: a sheet, or stripRegion() for a strip.
+    // Empty, the default, leaves the layout unbounded.
+    Rect sheet;
+};
+
+// Deterministic constructive placer. Parts go in by decreasing area; each
+// takes the cheapest overlap-free point among the vertices of its NFPs
+// against the parts already placed, the intersections of those NFPs' edges
+// and the corners of its IFPs in their cavities. Ties go to the lowest y,
+// then the lowest x. The first part sits at the origin. Fast enough for a
+// quick nest and a good starting layout for the Annealer: candidates clearly
+// inside another placed part's NFP are dropped before the exact overlap
+// test, and an NFP found buried under the others stops giving candidates to
+// parts of that kind and rotation.
+//
+// With a sheet, candidates must lie in each part's inner-fit rectangle,
+// whose corners and crossings with the NFPs are candidates too, and the
+// first part starts at its bottom-left corner. A part that fits nowhere on
+// the sheet is listed in NestResult::unplaced and left right of it.
+class BottomLeftFill
+{
+public:
+    BottomLeftFill(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const FillConfig& config = FillConfig());
+
+    NestResult run();
+
+    // Another thread may set this flag to end run() early; the parts not yet
+    // placed then go in a row right of the others. Not owned.
+    void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+
+private:
+    // The placed parts whose NFPs a candidate lies on; parts.size() for none
+    using Sources = std::pair<size_t, size_t>;
+
+    void collectCandidates(size_t index, size_t slot, const Rect& fit, const Layout& layout,
+                           std::vector<Point>& candidates, std::vector<Sources>& sources);
+    // Drops candidates off the sheet or inside an NFP, before any exact test
+    void filterCandidates(size_t index, size_t slot, const Rect& fit, const Layout& layout,
+                          std::vector<Point>& candidates, std::vector<Sources>& sources);
+
+    const std::vector<Part>& parts;
+    nfpcalculator& nfpCalc;
+    FillConfig config;
+    PartTable table;
+    const std::atomic<bool>* stopFlag = nullptr;
+
+    // Per placed part, its NFP with the part being placed, where that sits
+    // and the box holding it; an empty box where none was fetched
+    std::vector<NfpView> nfps;
+    std::vector<Point> nfpOrigins;
+    std::vector<Rect> nfpBoxes;
+    // Parts with equal hashes and scales are one kind. Per placed part, kind
+    // and slot: whether that NFP is buried under others, giving no candidates.
+    std::vector<size_t> kinds;
+    size_t kindSlots = 0;
+    std::vector<char> buried;
+};
+
+} // namespace nest
+
+#endif // NEST_BOTTOMLEFTFILL_H
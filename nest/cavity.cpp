@@ -0,0 +1,76 @@
+#include "cavity.h"
+#include "decomposition.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+// Distance below which an outline vertex lies on a hull edge
+static const double kEpsilon = 1e-7;
+
+static void addCavity(std::vector<Cavity>& cavities, const Polygon& loop, bool enclosed, double minArea)
+{
+    Cavity cavity;
+    cavity.region = cleanedPolygon(loop);
+    if (cavity.region.size() < 3) return;
+    cavity.area = signedArea(cavity.region);
+    cavity.enclosed = enclosed;
+    if (cavity.area >= minArea) cavities.push_back(std::move(cavity));
+}
+
+std::vector<Cavity> detectCavities(const Polygon& outline, const std::vector<Polygon>& innerRings, double minArea)
+{
+    std::vector<Cavity> cavities;
+    const Polygon poly = cleanedPolygon(outline);
+    const size_t n = poly.size();
+    if (n >= 4) {
+        // Hull vertices are outline vertices, met in the same cyclic order on both
+        const Polygon hull = convexHull(poly);
+        std::vector<size_t> onHull;
+        for (size_t i = 0; i < n; ++i) {
+            if (std::find(hull.begin(), hull.end(), poly[i]) != hull.end()) onHull.push_back(i);
+        }
+
+        // The outline between consecutive hull vertices and the hull edge
+        // joining them (the lid) bound one pocket
+        for (size_t k = 0; k < onHull.size(); ++k) {
+            const size_t from = onHull[k];
+            const size_t to = onHull[(k + 1) % onHull.size()];
+            const size_t steps = (to + n - from) % n;
+            if (steps < 2) continue;
+            const Point& lidStart = poly[from];
+            const Point& lidEnd = poly[to];
+            const double lidLength = std::hypot(lidEnd.x - lidStart.x, lidEnd.y - lidStart.y);
+
+            Polygon loop{lidStart};
+            for (size_t s = 1; s <= steps; ++s) {
+                const Point& p = poly[(from + s) % n];
+                loop.push_back(p);
+                const bool onLid = s == steps || std::abs(crossProduct(lidStart, lidEnd, p)) <= kEpsilon * lidLength;
+                if (!onLid) continue;
+                // Touching the lid closes this pocket and starts the next
+                if (loop.size() >= 3) addCavity(cavities, loop, false, minArea);
+                loop.assign(1, p);
+            }
+        }
+    }
+    // Drawings give holes either winding
+    for (const Polygon& ring : innerRings) {
+        if (signedArea(ring) >= 0) {
+            addCavity(cavities, ring, true, minArea);
+        } else {
+            addCavity(cavities, Polygon(ring.rbegin(), ring.rend()), true, minArea);
+        }
+    }
+
+    std::stable_sort(cavities.begin(), cavities.end(), [](const Cavity& a, const Cavity& b) { return a.area > b.area; });
+    return cavities;
+}
+
+size_t cavitiesAtLeast(const std::vector<Cavity>& cavities, double area)
+{
+    return std::partition_point(cavities.begin(), cavities.end(), [area](const Cavity& c) { return c.area >= area; }) -
+           cavities.begin();
+}
+
+} // namespace nest
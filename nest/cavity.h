@@ -0,0 +1,30 @@
+#ifndef NEST_CAVITY_H
+#define NEST_CAVITY_H
+
+#include "geometry.h"
+#include <cstddef>
+
+namespace nest {
+
+// A region of a part where smaller parts can nest without touching it: a
+// pocket between the outline and its convex hull, or an inner ring.
+struct Cavity
+{
+    Polygon region; // Counter-clockwise, local coordinates
+    double area = 0.0;
+    bool enclosed = false; // Inner ring rather than a pocket open to the hull
+};
+
+// Pockets of outline (hull minus polygon, one per hull edge the outline
+// leaves, split where it touches that edge again) plus the given inner
+// rings, largest area first. Slivers below minArea are dropped.
+std::vector<Cavity> detectCavities(const Polygon& outline, const std::vector<Polygon>& innerRings = {},
+                                   double minArea = 1e-6);
+
+// Number of leading cavities with at least the given area; cavities are
+// sorted largest first, so these are the only candidates for a part that big
+size_t cavitiesAtLeast(const std::vector<Cavity>& cavities, double area);
+
+} // namespace nest
+
+#endif // NEST_CAVITY_H
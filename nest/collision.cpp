@@ -0,0 +1,454 @@
+#include "collision.h"
+#include "fixedpoint.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace nest {
+
+// Distance below which a vertex counts as lying on an edge, so parts placed on
+// an NFP boundary touch rather than overlap
+static const double kEpsilon = 1e-7;
+
+// Segments p1-p2 and q1-q2 cross at a single point interior to both
+static bool segmentsCross(const Point& p1, const Point& p2, const Point& q1, const Point& q2)
+{
+    const double lp = std::hypot(p2.x - p1.x, p2.y - p1.y);
+    const double lq = std::hypot(q2.x - q1.x, q2.y - q1.y);
+    if (lp == 0.0 || lq == 0.0) return false;
+    // Signed distances of each endpoint from the other segment's line
+    const double d1 = crossProduct(q1, q2, p1) / lq;
+    const double d2 = crossProduct(q1, q2, p2) / lq;
+    const double d3 = crossProduct(p1, p2, q1) / lp;
+    const double d4 = crossProduct(p1, p2, q2) / lp;
+    return ((d1 > kEpsilon && d2 < -kEpsilon) || (d1 < -kEpsilon && d2 > kEpsilon)) &&
+           ((d3 > kEpsilon && d4 < -kEpsilon) || (d3 < -kEpsilon && d4 > kEpsilon));
+}
+
+// Distance from p to segment ab
+static double segmentDistance(const Point& p, const Point& a, const Point& b)
+{
+    const Point ab = b - a;
+    const double len2 = ab.x * ab.x + ab.y * ab.y;
+    double t = len2 > 0 ? ((p.x - a.x) * ab.x + (p.y - a.y) * ab.y) / len2 : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    const Point d = p - (a + ab * t);
+    return std::hypot(d.x, d.y);
+}
+
+// Inside poly and further than kEpsilon from its boundary
+static bool strictlyInside(const Polygon& poly, const Point& p)
+{
+    if (!containsPoint(poly, p)) return false;
+    const size_t n = poly.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (segmentDistance(p, poly[i], poly[(i + 1) % n]) <= kEpsilon) return false;
+    }
+    return true;
+}
+
+// Split each edge of a wherever b's boundary touches it and test the midpoint
+// of every piece. Finds overlaps whose boundary contacts are all collinear or
+// at vertices, e.g. two squares sharing both side lines.
+static bool boundaryEntersInterior(const Polygon& a, const Polygon& b)
+{
+    const size_t n = a.size();
+    const size_t m = b.size();
+    std::vector<double> cuts;
+    for (size_t i = 0; i < n; ++i) {
+        const Point& p1 = a[i];
+        const Point& p2 = a[(i + 1) % n];
+        const Point r = p2 - p1;
+        const double len2 = r.x * r.x + r.y * r.y;
+        if (len2 == 0.0) continue;
+        cuts.assign({0.0, 1.0});
+        for (size_t j = 0; j < m; ++j) {
+            const Point& q1 = b[j];
+            const Point& q2 = b[(j + 1) % m];
+            const Point s = q2 - q1;
+            const double denom = r.x * s.y - r.y * s.x;
+            if (denom != 0.0) {
+                const Point qp = q1 - p1;
+                const double t = (qp.x * s.y - qp.y * s.x) / denom;
+                const double u = (qp.x * r.y - qp.y * r.x) / denom;
+                if (t > 0 && t < 1 && u >= 0 && u <= 1) cuts.push_back(t);
+            }
+            // b's vertices on or near this edge, which covers collinear overlaps
+            const double tq = ((q1.x - p1.x) * r.x + (q1.y - p1.y) * r.y) / len2;
+            if (tq > 0 && tq < 1 && segmentDistance(q1, p1, p2) <= kEpsilon) cuts.push_back(tq);
+        }
+        std::sort(cuts.begin(), cuts.end());
+        for (size_t k = 0; k + 1 < cuts.size(); ++k) {
+            if (cuts[k + 1] - cuts[k] <= 0) continue;
+            if (strictlyInside(b, p1 + r * ((cuts[k] + cuts[k + 1]) * 0.5))) return true;
+        }
+    }
+    return false;
+}
+
+// A point strictly inside the polygon, a short step inward from the midpoint
+// of its longest edge. Catches coincident outlines that share every edge.
+static Point interiorPoint(const Polygon& poly)
+{
+    const size_t n = poly.size();
+    size_t best = 0;
+    double bestLength = -1.0;
+    for (size_t i = 0; i < n; ++i) {
+        const Point d = poly[(i + 1) % n] - poly[i];
+        const double length = d.x * d.x + d.y * d.y;
+        if (length > bestLength) {
+            bestLength = length;
+            best = i;
+        }
+    }
+    const Point a = poly[best];
+    const Point b = poly[(best + 1) % n];
+    const Point mid = (a + b) * 0.5;
+    const double length = std::sqrt(bestLength);
+    if (length == 0.0) return mid;
+    // Inward normal depends on winding
+    const double side = signedArea(poly) > 0 ? 1.0 : -1.0;
+    const Point normal{-(b.y - a.y) / length * side, (b.x - a.x) / length * side};
+    return mid + normal * (length * 1e-3);
+}
+
+bool polygonsOverlapExhaustive(const Polygon& a, const Polygon& b)
+{
+    if (a.size() < 3 || b.size() < 3) return false;
+    if (!boundingRect(a).intersects(boundingRect(b))) return false;
+
+    const size_t n = a.size();
+    const size_t m = b.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a1 = a[i];
+        const Point& a2 = a[(i + 1) % n];
+        for (size_t j = 0; j < m; ++j) {
+            if (segmentsCross(a1, a2, b[j], b[(j + 1) % m])) return true;
+        }
+    }
+
+    // No proper crossings: part of one boundary may still run through the
+    // other's interior, or the outlines coincide, or they are disjoint/touching
+    if (boundaryEntersInterior(a, b) || boundaryEntersInterior(b, a)) return true;
+    return strictlyInside(b, interiorPoint(a)) || strictlyInside(a, interiorPoint(b));
+}
+
+// True if some edge normal of a separates the two polygons. Projections that
+// overlap by no more than kEpsilon only touch.
+static bool separatedByEdgeOf(const Polygon& a, const Polygon& b)
+{
+    const size_t n = a.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point d = a[(i + 1) % n] - a[i];
+        const double length = std::sqrt(d.x * d.x + d.y * d.y);
+        if (length == 0.0) continue;
+        // Unnormalized axis; the tolerance is scaled to match instead
+        const Point axis{-d.y, d.x};
+        auto project = [&axis](const Polygon& poly, double& lo, double& hi) {
+            lo = hi = poly.front().x * axis.x + poly.front().y * axis.y;
+            for (const Point& p : poly) {
+                const double t = p.x * axis.x + p.y * axis.y;
+                lo = std::min(lo, t);
+                hi = std::max(hi, t);
+            }
+        };
+        double minA, maxA, minB, maxB;
+        project(a, minA, maxA);
+        project(b, minB, maxB);
+        const double tolerance = kEpsilon * length;
+        if (maxA - minB <= tolerance || maxB - minA <= tolerance) return true;
+    }
+    return false;
+}
+
+namespace {
+
+// An edge that reaches into the window where the two outlines can meet
+struct Edge
+{
+    Point p1, p2;
+    Rect box; // Grown by kEpsilon so near contacts still pair up
+};
+
+using EdgePairs = std::vector<std::pair<uint32_t, uint32_t>>;
+
+// Working storage for the narrow phase, one set per thread, so tests stop
+// allocating once the buffers have grown to the largest outlines seen
+struct Scratch
+{
+    std::vector<Edge> ea, eb;
+    EdgePairs pairs;
+    std::vector<uint32_t> activeA, activeB;
+    std::vector<double> cuts;
+    std::vector<FixedPoint> fa, fb, fixedCuts;
+};
+
+Scratch& scratch()
+{
+    thread_local Scratch buffers;
+    return buffers;
+}
+
+} // namespace
+
+// Edges of poly whose boxes meet window, sorted by left end
+static void windowEdges(const Polygon& poly, const Rect& window, std::vector<Edge>& edges)
+{
+    edges.clear();
+    const size_t n = poly.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point& p1 = poly[i];
+        const Point& p2 = poly[(i + 1) % n];
+        const Rect box{std::min(p1.x, p2.x) - kEpsilon, std::min(p1.y, p2.y) - kEpsilon,
+                       std::max(p1.x, p2.x) + kEpsilon, std::max(p1.y, p2.y) + kEpsilon};
+        if (box.intersects(window)) edges.push_back({p1, p2, box});
+    }
+    std::sort(edges.begin(), edges.end(), [](const Edge& e, const Edge& f) { return e.box.minX < f.box.minX; });
+}
+
+// Sort and sweep along x: every (edge of a, edge of b) whose boxes meet
+static void candidatePairs(const std::vector<Edge>& ea, const std::vector<Edge>& eb, EdgePairs& pairs,
+                           std::vector<uint32_t>& activeA, std::vector<uint32_t>& activeB)
+{
+    pairs.clear();
+    activeA.clear();
+    activeB.clear();
+    size_t i = 0, j = 0;
+    while (i < ea.size() || j < eb.size()) {
+        const bool takeA = j == eb.size() || (i < ea.size() && ea[i].box.minX <= eb[j].box.minX);
+        const Edge& e = takeA ? ea[i] : eb[j];
+        std::vector<uint32_t>& others = takeA ? activeB : activeA;
+        const std::vector<Edge>& otherEdges = takeA ? eb : ea;
+        others.erase(std::remove_if(others.begin(), others.end(),
+                                    [&](uint32_t k) { return otherEdges[k].box.maxX < e.box.minX; }),
+                     others.end());
+        for (uint32_t k : others) {
+            if (!e.box.intersects(otherEdges[k].box)) continue;
+            pairs.emplace_back(takeA ? uint32_t(i) : k, takeA ? k : uint32_t(j));
+        }
+        if (takeA) {
+            activeA.push_back(uint32_t(i++));
+        } else {
+            activeB.push_back(uint32_t(j++));
+        }
+    }
+}
+
+// boundaryEntersInterior() restricted to the paired edges. pairs are
+// (edge, other edge). Unpaired edges never come near other's boundary, so
+// each lies on the same side as the pieces of the paired edges next to it.
+static bool piecesEnterInterior(const std::vector<Edge>& edges, const std::vector<Edge>& otherEdges,
+                                EdgePairs& pairs, const Polygon& other, std::vector<double>& cuts)
+{
+    std::sort(pairs.begin(), pairs.end());
+    for (size_t start = 0, end = 0; start < pairs.size(); start = end) {
+        while (end < pairs.size() && pairs[end].first == pairs[start].first) ++end;
+        const Point& p1 = edges[pairs[start].first].p1;
+        const Point& p2 = edges[pairs[start].first].p2;
+        const Point r = p2 - p1;
+        const double len2 = r.x * r.x + r.y * r.y;
+        if (len2 == 0.0) continue;
+        cuts.assign({0.0, 1.0});
+        for (size_t k = start; k < end; ++k) {
+            const Point& q1 = otherEdges[pairs[k].second].p1;
+            const Point s = otherEdges[pairs[k].second].p2 - q1;
+            const double denom = r.x * s.y - r.y * s.x;
+            if (denom != 0.0) {
+                const Point qp = q1 - p1;
+                const double t = (qp.x * s.y - qp.y * s.x) / denom;
+                const double u = (qp.x * r.y - qp.y * r.x) / denom;
+                if (t > 0 && t < 1 && u >= 0 && u <= 1) cuts.push_back(t);
+            }
+            const double tq = ((q1.x - p1.x) * r.x + (q1.y - p1.y) * r.y) / len2;
+            if (tq > 0 && tq < 1 && segmentDistance(q1, p1, p2) <= kEpsilon) cuts.push_back(tq);
+        }
+        std::sort(cuts.begin(), cuts.end());
+        for (size_t c = 0; c + 1 < cuts.size(); ++c) {
+            if (cuts[c + 1] - cuts[c] <= 0) continue;
+            const Point mid = p1 + r * ((cuts[c] + cuts[c + 1]) * 0.5);
+            if (!containsPoint(other, mid)) continue;
+            // Only paired edges can be within kEpsilon of a point on this edge
+            bool onBoundary = false;
+            for (size_t k = start; k < end && !onBoundary; ++k) {
+                const Edge& f = otherEdges[pairs[k].second];
+                onBoundary = segmentDistance(mid, f.p1, f.p2) <= kEpsilon;
+            }
+            if (!onBoundary) return true;
+        }
+    }
+    return false;
+}
+
+// Exact variants for the fixed-point grid. Outlines are converted at twice
+// the grid resolution, so the midpoint between two grid points is a grid
+// point too and the pieces an edge is cut into can be tested exactly.
+static FixedPoint doubledFixed(const Point& p)
+{
+    const FixedPoint f = toFixed(p);
+    return {f.x * 2, f.y * 2};
+}
+
+static void doubledFixed(const Polygon& poly, std::vector<FixedPoint>& out)
+{
+    out.clear();
+    for (const Point& p : poly) out.push_back(doubledFixed(p));
+}
+
+// Some edge line of convex a has all of b on its outer side or on the line
+static bool separatedOnGrid(const std::vector<FixedPoint>& a, const std::vector<FixedPoint>& b, int winding)
+{
+    const size_t n = a.size();
+    for (size_t i = 0; i < n; ++i) {
+        const FixedPoint& a1 = a[i];
+        const FixedPoint& a2 = a[(i + 1) % n];
+        if (a1 == a2) continue;
+        bool separated = true;
+        for (const FixedPoint& q : b) {
+            if (orientation(a1, a2, q) * winding > 0) {
+                separated = false;
+                break;
+            }
+        }
+        if (separated) return true;
+    }
+    return false;
+}
+
+// Cuts each paired edge at the other outline's vertices lying on it and
+// locates the midpoint of every piece. Without proper crossings the pieces
+// are each wholly inside, outside or on the other boundary. onBoundary stays
+// true only if every piece lies on it; edgeCount counts the edges seen.
+static bool piecesInsideOnGrid(const std::vector<Edge>& edges, const std::vector<Edge>& otherEdges, EdgePairs& pairs,
+                               const std::vector<FixedPoint>& other, bool& onBoundary, size_t& edgeCount,
+                               std::vector<FixedPoint>& cuts)
+{
+    std::sort(pairs.begin(), pairs.end());
+    for (size_t start = 0, end = 0; start < pairs.size(); start = end) {
+        while (end < pairs.size() && pairs[end].first == pairs[start].first) ++end;
+        ++edgeCount;
+        const FixedPoint p1 = doubledFixed(edges[pairs[start].first].p1);
+        const FixedPoint p2 = doubledFixed(edges[pairs[start].first].p2);
+        if (p1 == p2) continue;
+        cuts.assign({p1, p2});
+        for (size_t k = start; k < end; ++k) {
+            const Edge& f = otherEdges[pairs[k].second];
+            for (const Point& q : {f.p1, f.p2}) {
+                const FixedPoint c = doubledFixed(q);
+                if (orientation(p1, p2, c) != 0) continue;
+                if (c.x < std::min(p1.x, p2.x) || c.x > std::max(p1.x, p2.x) || c.y < std::min(p1.y, p2.y) ||
+                    c.y > std::max(p1.y, p2.y)) {
+                    continue;
+                }
+                cuts.push_back(c);
+            }
+        }
+        // Points on one segment are in order along it when sorted lexicographically
+        std::sort(cuts.begin(), cuts.end(),
+                  [](const FixedPoint& u, const FixedPoint& v) { return u.x < v.x || (u.x == v.x && u.y < v.y); });
+        cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+        for (size_t c = 0; c + 1 < cuts.size(); ++c) {
+            const FixedPoint mid{(cuts[c].x + cuts[c + 1].x) / 2, (cuts[c].y + cuts[c + 1].y) / 2};
+            const Location location = locate(other, mid);
+            if (location == Location::Inside) return true;
+            if (location == Location::Outside) onBoundary = false;
+        }
+    }
+    return false;
+}
+
+static bool overlapOnGrid(const Polygon& a, const Polygon& b, Scratch& s)
+{
+    const std::vector<Edge>& ea = s.ea;
+    const std::vector<Edge>& eb = s.eb;
+    EdgePairs& pairs = s.pairs;
+    for (const auto& pair : pairs) {
+        const FixedPoint p1 = doubledFixed(ea[pair.first].p1), p2 = doubledFixed(ea[pair.first].p2);
+        const FixedPoint q1 = doubledFixed(eb[pair.second].p1), q2 = doubledFixed(eb[pair.second].p2);
+        if (orientation(q1, q2, p1) * orientation(q1, q2, p2) < 0 && orientation(p1, p2, q1) * orientation(p1, p2, q2) < 0) {
+            return true;
+        }
+    }
+
+    std::vector<FixedPoint>& fa = s.fa;
+    std::vector<FixedPoint>& fb = s.fb;
+    doubledFixed(a, fa);
+    doubledFixed(b, fb);
+    bool aOnBoundary = true, bOnBoundary = true;
+    size_t aEdges = 0, bEdges = 0;
+    if (piecesInsideOnGrid(ea, eb, pairs, fb, aOnBoundary, aEdges, s.fixedCuts)) return true;
+    for (auto& pair : pairs) std::swap(pair.first, pair.second);
+    if (piecesInsideOnGrid(eb, ea, pairs, fa, bOnBoundary, bEdges, s.fixedCuts)) return true;
+
+    // All of one boundary on the other: the outlines coincide
+    if (!pairs.empty() && ((aOnBoundary && aEdges == a.size()) || (bOnBoundary && bEdges == b.size()))) return true;
+    // Otherwise they touch without overlapping, or do not touch and one may hold the other
+    return locate(fb, fa[0]) == Location::Inside || locate(fa, fb[0]) == Location::Inside;
+}
+
+bool polygonsOverlap(const CollisionShape& a, const CollisionShape& b)
+{
+    if (a.outline.size() < 3 || b.outline.size() < 3) return false;
+    if (!a.bounds.intersects(b.bounds)) return false;
+    NEST_COUNT(NarrowPhaseTest);
+    Scratch& s = scratch();
+    if (a.convex && b.convex && gridEnabled()) {
+        doubledFixed(a.outline, s.fa);
+        doubledFixed(b.outline, s.fb);
+        const int windingA = signedArea(a.outline) > 0 ? 1 : -1;
+        const int windingB = signedArea(b.outline) > 0 ? 1 : -1;
+        return !separatedOnGrid(s.fa, s.fb, windingA) && !separatedOnGrid(s.fb, s.fa, windingB);
+    }
+    if (a.convex && b.convex) {
+        return !separatedByEdgeOf(a.outline, b.outline) && !separatedByEdgeOf(b.outline, a.outline);
+    }
+
+    // Only edges inside the overlap of the two boxes can cross or touch
+    const Rect window{std::max(a.bounds.minX, b.bounds.minX) - kEpsilon, std::max(a.bounds.minY, b.bounds.minY) - kEpsilon,
+                      std::min(a.bounds.maxX, b.bounds.maxX) + kEpsilon, std::min(a.bounds.maxY, b.bounds.maxY) + kEpsilon};
+    std::vector<Edge>& ea = s.ea;
+    std::vector<Edge>& eb = s.eb;
+    EdgePairs& pairs = s.pairs;
+    windowEdges(a.outline, window, ea);
+    windowEdges(b.outline, window, eb);
+    candidatePairs(ea, eb, pairs, s.activeA, s.activeB);
+    if (gridEnabled()) return overlapOnGrid(a.outline, b.outline, s);
+    for (const auto& pair : pairs) {
+        const Edge& e = ea[pair.first];
+        const Edge& f = eb[pair.second];
+        if (segmentsCross(e.p1, e.p2, f.p1, f.p2)) return true;
+    }
+
+    if (!pairs.empty()) {
+        if (piecesEnterInterior(ea, eb, pairs, b.outline, s.cuts)) return true;
+        for (auto& pair : pairs) std::swap(pair.first, pair.second);
+        if (piecesEnterInterior(eb, ea, pairs, a.outline, s.cuts)) return true;
+    }
+    // No contact at all leaves containment; coincident outlines also end up here
+    return strictlyInside(b.outline, interiorPoint(a.outline)) || strictlyInside(a.outline, interiorPoint(b.outline));
+}
+
+bool polygonWithin(const Polygon& inner, const Polygon& outer)
+{
+    if (inner.size() < 3 || outer.size() < 3) return false;
+    const Rect innerBounds = boundingRect(inner);
+    const Rect outerBounds = boundingRect(outer);
+    if (innerBounds.minX < outerBounds.minX - kEpsilon || innerBounds.maxX > outerBounds.maxX + kEpsilon ||
+        innerBounds.minY < outerBounds.minY - kEpsilon || innerBounds.maxY > outerBounds.maxY + kEpsilon) {
+        return false;
+    }
+    // Any crossing, or a stretch of outer's boundary inside inner, cuts inner;
+    // without one, inner is all inside or all outside
+    if (boundaryEntersInterior(outer, inner)) return false;
+    return strictlyInside(outer, interiorPoint(inner));
+}
+
+bool polygonsOverlap(const Polygon& a, const Polygon& b)
+{
+    const Rect boundsA = boundingRect(a);
+    const Rect boundsB = boundingRect(b);
+    return polygonsOverlap(CollisionShape{a, boundsA, isConvex(a)}, CollisionShape{b, boundsB, isConvex(b)});
+}
+
+} // namespace nest
@@ -0,0 +1,34 @@
+#ifndef NEST_COLLISION_H
+#define NEST_COLLISION_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// A placed outline plus the facts the overlap test would otherwise recompute
+// on every call. Convexity survives rotation and scaling, so callers can take
+// it from isConvex() on the part's own outline once.
+struct CollisionShape
+{
+    const Polygon& outline;
+    const Rect& bounds;
+    bool convex;
+};
+
+// True when the interiors of the two polygons overlap. Touching edges and
+// shared vertices are not an overlap, so parts may be nested edge to edge.
+// Convex pairs use separating axes; anything else sweeps only the edges in
+// the overlap of the two bounding boxes.
+bool polygonsOverlap(const CollisionShape& a, const CollisionShape& b);
+bool polygonsOverlap(const Polygon& a, const Polygon& b);
+
+// True when inner lies inside outer, boundaries allowed to touch: how a part
+// sits in another part's hole
+bool polygonWithin(const Polygon& inner, const Polygon& outer);
+
+// Same predicate testing every edge pair; reference for the fast kernel
+bool polygonsOverlapExhaustive(const Polygon& a, const Polygon& b);
+
+} // namespace nest
+
+#endif // NEST_COLLISION_H
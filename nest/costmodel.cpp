@@ -0,0 +1,92 @@
+#include "costmodel.h"
+#include <algorithm>
+#include <iterator>
+
+namespace nest {
+
+// Weight of strip area spent above stripHeight
+static const double kOverflowWeight = 4.0;
+
+CostModel::CostModel(Objective objective, const std::vector<Rect>& boxes, double partArea, double stripHeight)
+    : objective(objective), partArea(partArea), stripHeight(stripHeight), boxes(boxes)
+{
+    for (const Rect& box : boxes) {
+        if (box.isEmpty()) continue;
+        minX.insert(box.minX);
+        minY.insert(box.minY);
+        maxX.insert(box.maxX);
+        maxY.insert(box.maxY);
+    }
+}
+
+void CostModel::move(size_t index, const Rect& box)
+{
+    Rect& old = boxes[index];
+    if (!old.isEmpty() && !box.isEmpty()) {
+        // Re-key the part's own nodes rather than freeing and allocating new ones
+        auto rekey = [](std::multiset<double>& values, double from, double to) {
+            auto node = values.extract(values.find(from));
+            node.value() = to;
+            values.insert(std::move(node));
+        };
+        rekey(minX, old.minX, box.minX);
+        rekey(minY, old.minY, box.minY);
+        rekey(maxX, old.maxX, box.maxX);
+        rekey(maxY, old.maxY, box.maxY);
+    } else if (!old.isEmpty()) {
+        minX.erase(minX.find(old.minX));
+        minY.erase(minY.find(old.minY));
+        maxX.erase(maxX.find(old.maxX));
+        maxY.erase(maxY.find(old.maxY));
+    } else if (!box.isEmpty()) {
+        minX.insert(box.minX);
+        minY.insert(box.minY);
+        maxX.insert(box.maxX);
+        maxY.insert(box.maxY);
+    }
+    old = box;
+}
+
+Rect CostModel::extent() const
+{
+    if (minX.empty()) return Rect();
+    return {*minX.begin(), *minY.begin(), *maxX.rbegin(), *maxY.rbegin()};
+}
+
+Rect CostModel::extentWith(size_t index, const Rect& box) const
+{
+    const Rect& old = boxes[index];
+    if (old.isEmpty()) return extent().united(box);
+    if (minX.size() <= 1) return box; // Only part in the layout
+
+    // Extremes of the other parts: the first entry, or the second if the
+    // first is this part's own. Equal values are interchangeable.
+    auto lowest = [](const std::multiset<double>& values, double own) {
+        auto it = values.begin();
+        return *it == own ? *std::next(it) : *it;
+    };
+    auto highest = [](const std::multiset<double>& values, double own) {
+        auto it = values.rbegin();
+        return *it == own ? *std::next(it) : *it;
+    };
+    const Rect rest{lowest(minX, old.minX), lowest(minY, old.minY), highest(maxX, old.maxX), highest(maxY, old.maxY)};
+    return rest.united(box);
+}
+
+double CostModel::evaluate(const Rect& extent) const
+{
+    switch (objective) {
+    case Objective::StripLength: {
+        const double height = std::max(stripHeight, 1e-9);
+        const double overflow = std::max(0.0, extent.height() - height);
+        return extent.width() * (height + kOverflowWeight * overflow);
+    }
+    case Objective::Utilization:
+        return extent.area() > 0 ? 1.0 - partArea / extent.area() : 1.0;
+    case Objective::BoundingArea:
+        break;
+    }
+    return extent.area();
+}
+
+} // namespace nest
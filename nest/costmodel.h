@@ -0,0 +1,49 @@
+#ifndef NEST_COSTMODEL_H
+#define NEST_COSTMODEL_H
+
+#include "geometry.h"
+#include <cstddef>
+#include <set>
+#include <vector>
+
+namespace nest {
+
+// What the optimizer minimizes. Costs are in the objective's own units, so
+// annealing temperatures have to be chosen to match.
+enum class Objective
+{
+    BoundingArea, // Area of the bounding rectangle of all parts
+    StripLength,  // Strip area used along x for a strip stripHeight tall; overflow in y counts extra
+    Utilization   // Wasted fraction of the bounding rectangle, 1 - part area / rectangle area
+};
+
+// Layout cost from the parts' bounding boxes, kept as sorted extents per axis
+// so one part's move is scored in O(1) and applied in O(log n), without
+// looking at the other parts.
+class CostModel
+{
+public:
+    CostModel() = default;
+    CostModel(Objective objective, const std::vector<Rect>& boxes, double partArea, double stripHeight = 0.0);
+
+    double cost() const { return evaluate(extent()); }
+    // Cost if part index had box instead; the model is not changed
+    double costWith(size_t index, const Rect& box) const { return evaluate(extentWith(index, box)); }
+    void move(size_t index, const Rect& box);
+
+    Rect extent() const;
+    Rect extentWith(size_t index, const Rect& box) const;
+
+private:
+    double evaluate(const Rect& extent) const;
+
+    Objective objective = Objective::BoundingArea;
+    double partArea = 0.0;
+    double stripHeight = 0.0;
+    std::vector<Rect> boxes;
+    std::multiset<double> minX, minY, maxX, maxY;
+};
+
+} // namespace nest
+
+#endif // NEST_COSTMODEL_H
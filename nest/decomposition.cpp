@@ -0,0 +1,149 @@
+#include "decomposition.h"
+#include "fixedpoint.h"
+#include <algorithm>
+
+namespace nest {
+
+Polygon cleanedPolygon(const Polygon& poly)
+{
+    Polygon out = poly;
+    removeCollinear(out);
+    if (signedArea(out) < 0) std::reverse(out.begin(), out.end());
+    return out;
+}
+
+// p inside or on the boundary of the counter-clockwise triangle abc
+static bool inTriangle(const Point& p, const Point& a, const Point& b, const Point& c)
+{
+    return orientation(a, b, p) >= 0 && orientation(b, c, p) >= 0 && orientation(c, a, p) >= 0;
+}
+
+// Ear clipping over vertex indices of a counter-clockwise simple polygon
+static std::vector<std::vector<int>> triangulate(const Polygon& poly)
+{
+    std::vector<std::vector<int>> triangles;
+    std::vector<int> remaining(poly.size());
+    for (size_t i = 0; i < poly.size(); ++i) remaining[i] = int(i);
+
+    while (remaining.size() > 3) {
+        const size_t n = remaining.size();
+        bool clipped = false;
+        for (size_t i = 0; i < n && !clipped; ++i) {
+            const int prev = remaining[(i + n - 1) % n];
+            const int cur = remaining[i];
+            const int next = remaining[(i + 1) % n];
+            if (orientation(poly[prev], poly[cur], poly[next]) <= 0) continue; // Reflex or flat
+
+            bool isEar = true;
+            for (size_t j = 0; j < n && isEar; ++j) {
+                const int other = remaining[j];
+                if (other == prev || other == cur || other == next) continue;
+                if (poly[other] == poly[prev] || poly[other] == poly[cur] || poly[other] == poly[next]) continue;
+                isEar = !inTriangle(poly[other], poly[prev], poly[cur], poly[next]);
+            }
+            if (isEar) {
+                triangles.push_back({prev, cur, next});
+                remaining.erase(remaining.begin() + i);
+                clipped = true;
+            }
+        }
+        if (!clipped) {
+            // Not simple within floating point precision: clip the most convex vertex anyway
+            size_t best = 0;
+            double bestCross = -1e300;
+            for (size_t i = 0; i < n; ++i) {
+                const double c = crossProduct(poly[remaining[(i + n - 1) % n]], poly[remaining[i]], poly[remaining[(i + 1) % n]]);
+                if (c > bestCross) {
+                    bestCross = c;
+                    best = i;
+                }
+            }
+            if (bestCross > 0) {
+                triangles.push_back({remaining[(best + n - 1) % n], remaining[best], remaining[(best + 1) % n]});
+            }
+            remaining.erase(remaining.begin() + best);
+        }
+    }
+    if (remaining.size() == 3 && orientation(poly[remaining[0]], poly[remaining[1]], poly[remaining[2]]) > 0) {
+        triangles.push_back(remaining);
+    }
+    return triangles;
+}
+
+// Position of directed edge u -> v in piece, or -1
+static int findEdge(const std::vector<int>& piece, int u, int v)
+{
+    const size_t n = piece.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (piece[i] == u && piece[(i + 1) % n] == v) return int(i);
+    }
+    return -1;
+}
+
+static bool isConvexPiece(const Polygon& poly, const std::vector<int>& piece)
+{
+    const size_t n = piece.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (orientation(poly[piece[i]], poly[piece[(i + 1) % n]], poly[piece[(i + 2) % n]]) < 0) return false;
+    }
+    return true;
+}
+
+// Join a (containing edge u -> v) and b (containing v -> u) across that diagonal
+static std::vector<int> mergeAcross(const std::vector<int>& a, int edgeA, const std::vector<int>& b, int edgeB)
+{
+    std::vector<int> merged;
+    const size_t n = a.size();
+    const size_t m = b.size();
+    // a from v round to u, then b strictly between u and v
+    for (size_t k = 0; k < n; ++k) merged.push_back(a[(edgeA + 1 + k) % n]);
+    for (size_t k = 2; k < m; ++k) merged.push_back(b[(edgeB + k) % m]);
+    return merged;
+}
+
+std::vector<Polygon> convexDecomposition(const Polygon& input)
+{
+    const Polygon poly = cleanedPolygon(input);
+    if (poly.size() < 3) return {};
+    if (isConvex(poly)) return {poly};
+
+    std::vector<std::vector<int>> pieces = triangulate(poly);
+
+    // Hertel-Mehlhorn: drop any diagonal whose removal leaves a convex piece
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < pieces.size() && !merged; ++i) {
+            const std::vector<int>& a = pieces[i];
+            for (size_t e = 0; e < a.size() && !merged; ++e) {
+                const int u = a[e];
+                const int v = a[(e + 1) % a.size()];
+                if ((u + 1) % int(poly.size()) == v) continue; // Polygon edge, not a diagonal
+                for (size_t j = 0; j < pieces.size() && !merged; ++j) {
+                    if (j == i) continue;
+                    const int edgeB = findEdge(pieces[j], v, u);
+                    if (edgeB < 0) continue;
+                    std::vector<int> candidate = mergeAcross(a, int(e), pieces[j], edgeB);
+                    if (isConvexPiece(poly, candidate)) {
+                        pieces[i] = std::move(candidate);
+                        pieces.erase(pieces.begin() + j);
+                        merged = true;
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<Polygon> result;
+    result.reserve(pieces.size());
+    for (const std::vector<int>& piece : pieces) {
+        Polygon convex;
+        convex.reserve(piece.size());
+        for (int index : piece) convex.push_back(poly[index]);
+        removeCollinear(convex);
+        result.push_back(std::move(convex));
+    }
+    return result;
+}
+
+} // namespace nest
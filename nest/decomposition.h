@@ -0,0 +1,20 @@
+#ifndef NEST_DECOMPOSITION_H
+#define NEST_DECOMPOSITION_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// Simple polygon cleaned for the exact algorithms: counter-clockwise, no
+// repeated closing vertex, no zero-length or collinear edges.
+Polygon cleanedPolygon(const Polygon& poly);
+
+// Split a simple polygon into convex pieces: ear clipping, then
+// Hertel-Mehlhorn removal of inessential diagonals, giving at most four times
+// the optimal number of pieces. Convex input comes back as a single piece.
+// Every piece is counter-clockwise.
+std::vector<Polygon> convexDecomposition(const Polygon& poly);
+
+} // namespace nest
+
+#endif // NEST_DECOMPOSITION_H
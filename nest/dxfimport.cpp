@@ -0,0 +1,458 @@
+#include "flatten.h"
+#include "geometryhash.h"
+#include "importsupport.h"
+#include "partimport.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <unordered_map>
+
+namespace nest {
+
+namespace {
+
+// One entity's group codes. DXF reuses codes per entity type: 40 is a
+// radius, an axis ratio or a spline knot; 41 an ellipse start or a spline
+// weight; 42 a polyline bulge or an ellipse end.
+struct Entity
+{
+    std::string type;
+    std::string layer = "0";
+    Polygon points;              // 10/20
+    Polygon secondPoints;        // 11/21
+    std::vector<double> bulges;  // 42 per vertex, polylines only
+    std::vector<double> values40;
+    std::vector<double> values41;
+    double value42 = 0.0;
+    double startAngle = 0.0;     // 50
+    double endAngle = 0.0;       // 51
+    int flags = 0;               // 70
+    int degree = 3;              // 71
+    bool mirrored = false;       // 230 < 0: object coordinates run with x reversed
+
+    void clear()
+    {
+        type.clear();
+        layer = "0";
+        points.clear();
+        secondPoints.clear();
+        bulges.clear();
+        values40.clear();
+        values41.clear();
+        value42 = startAngle = endAngle = 0.0;
+        flags = 0;
+        degree = 3;
+        mirrored = false;
+    }
+};
+
+// Reads group code and value line pairs, trimmed
+class GroupReader
+{
+public:
+    explicit GroupReader(std::istream& in) : in(in) {}
+
+    bool next(int& code, std::string& value)
+    {
+        if (!std::getline(in, line)) return false;
+        trim(line);
+        const char* p = line.data();
+        double number = 0.0;
+        if (!parseNumber(p, line.data() + line.size(), number) || p != line.data() + line.size()) return false;
+        code = int(number);
+        if (!std::getline(in, value)) return false;
+        trim(value);
+        return true;
+    }
+
+private:
+    static void trim(std::string& text)
+    {
+        const size_t first = text.find_first_not_of(" \t\r\n");
+        if (first == std::string::npos) {
+            text.clear();
+            return;
+        }
+        text.erase(text.find_last_not_of(" \t\r\n") + 1);
+        text.erase(0, first);
+    }
+
+    std::istream& in;
+    std::string line;
+};
+
+bool toNumber(const std::string& text, double& value)
+{
+    const char* p = text.data();
+    return parseNumber(p, p + text.size(), value);
+}
+
+bool isNear(const Point& a, const Point& b, double tolerance)
+{
+    return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance;
+}
+
+// Sweep from start to end counter-clockwise, in (0, full]. Ends that meet
+// up to rounding, as in a file's 0 to 6.28318530718, are a full turn.
+double counterClockwiseSweep(double start, double end, double full)
+{
+    double sweep = std::fmod(end - start, full);
+    if (sweep <= 1e-9 * full) sweep += full;
+    return sweep;
+}
+
+// A bulge is tan(angle / 4) of the arc to the next vertex, positive
+// counter-clockwise; 0 is a straight segment
+void addBulgeSegment(const Point& from, const Point& to, double bulge, double tolerance, Polygon& out)
+{
+    if (bulge == 0 || from == to) {
+        out.push_back(to);
+        return;
+    }
+    const Point chord = to - from;
+    const double offset = (1.0 - bulge * bulge) / (4.0 * bulge);
+    const Point center{(from.x + to.x) * 0.5 - chord.y * offset, (from.y + to.y) * 0.5 + chord.x * offset};
+    const double radius = std::hypot(from.x - center.x, from.y - center.y);
+    const double start = std::atan2(from.y - center.y, from.x - center.x);
+    flattenArc(center, radius, radius, 0, start, 4.0 * std::atan(bulge), tolerance, out);
+    out.back() = to;
+}
+
+// Rational B-spline by de Boor's algorithm
+class Spline
+{
+public:
+    static const int MaxDegree = 15;
+
+    explicit Spline(const Entity& entity)
+        : degree(entity.degree), control(entity.points), knots(entity.values40), weights(entity.values41)
+    {
+        if (weights.size() != control.size()) weights.assign(control.size(), 1.0);
+    }
+
+    bool isValid() const
+    {
+        return degree >= 1 && degree <= MaxDegree && control.size() > size_t(degree) &&
+               knots.size() == control.size() + size_t(degree) + 1;
+    }
+
+    Point at(double t) const
+    {
+        const size_t n = control.size();
+        size_t span = size_t(degree);
+        while (span + 1 < n && t >= knots[span + 1]) ++span;
+
+        double x[MaxDegree + 1], y[MaxDegree + 1], w[MaxDegree + 1];
+        for (int j = 0; j <= degree; ++j) {
+            const size_t i = span - size_t(degree) + size_t(j);
+            w[j] = weights[i];
+            x[j] = control[i].x * w[j];
+            y[j] = control[i].y * w[j];
+        }
+        for (int r = 1; r <= degree; ++r) {
+            for (int j = degree; j >= r; --j) {
+                const size_t i = span - size_t(degree) + size_t(j);
+                const double width = knots[i + size_t(degree) + 1 - size_t(r)] - knots[i];
+                const double alpha = width > 0 ? (t - knots[i]) / width : 0.0;
+                x[j] = (1 - alpha) * x[j - 1] + alpha * x[j];
+                y[j] = (1 - alpha) * y[j - 1] + alpha * y[j];
+                w[j] = (1 - alpha) * w[j - 1] + alpha * w[j];
+            }
+        }
+        const double weight = w[degree] != 0 ? w[degree] : 1.0;
+        return {x[degree] / weight, y[degree] / weight};
+    }
+
+    // Flattened knot span by knot span, so no span's detail is skipped
+    void flatten(double tolerance, Polygon& out) const
+    {
+        const size_t n = control.size();
+        out.push_back(at(knots[size_t(degree)]));
+        const auto curve = [this](double t) { return at(t); };
+        for (size_t i = size_t(degree); i < n; ++i) {
+            if (knots[i + 1] > knots[i]) flattenCurve(curve, knots[i], knots[i + 1], tolerance, out);
+        }
+    }
+
+private:
+    int degree;
+    const Polygon& control;
+    const std::vector<double>& knots;
+    std::vector<double> weights;
+};
+
+// Open pieces in one arena until the end of the file, when those whose ends
+// meet are chained into rings
+class SegmentChainer
+{
+public:
+    explicit SegmentChainer(double tolerance) : tolerance(tolerance) {}
+
+    void add(uint32_t layer, const Polygon& points)
+    {
+        if (points.size() < 2) return;
+        segments.push_back({arena.size(), points.size(), layer});
+        arena.insert(arena.end(), points.begin(), points.end());
+    }
+
+    template <typename Fn>
+    void chain(Fn&& ring)
+    {
+        std::unordered_map<uint64_t, std::vector<size_t>> ends;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            ends[cellKey(first(i), 0, 0)].push_back(2 * i);
+            ends[cellKey(last(i), 0, 0)].push_back(2 * i + 1);
+        }
+
+        std::vector<char> used(segments.size(), 0);
+        auto find = [&](const Point& p) -> size_t {
+            for (int dx = -1; dx <= 1; ++dx) {
+                for (int dy = -1; dy <= 1; ++dy) {
+                    auto it = ends.find(cellKey(p, dx, dy));
+                    if (it == ends.end()) continue;
+                    for (size_t end : it->second) {
+                        const size_t s = end / 2;
+                        if (!used[s] && isNear(end % 2 ? last(s) : first(s), p, tolerance)) return end;
+                    }
+                }
+            }
+            return SIZE_MAX;
+        };
+
+        Polygon current;
+        for (size_t s = 0; s < segments.size(); ++s) {
+            if (used[s]) continue;
+            used[s] = 1;
+            current.assign(arena.begin() + segments[s].first, arena.begin() + segments[s].first + segments[s].count);
+            while (!isNear(current.front(), current.back(), tolerance)) {
+                const size_t end = find(current.back());
+                if (end == SIZE_MAX) break;
+                const Segment& next = segments[end / 2];
+                used[end / 2] = 1;
+                const auto begin = arena.begin() + next.first;
+                if (end % 2) {
+                    current.insert(current.end(), std::make_reverse_iterator(begin + next.count - 1),
+                                   std::make_reverse_iterator(begin));
+                } else {
+                    current.insert(current.end(), begin + 1, begin + next.count);
+                }
+            }
+            if (current.size() >= 3 && isNear(current.front(), current.back(), tolerance)) {
+                current.pop_back();
+                ring(segments[s].layer, current);
+            }
+        }
+    }
+
+private:
+    struct Segment
+    {
+        size_t first;
+        size_t count;
+        uint32_t layer;
+    };
+
+    const Point& first(size_t s) const { return arena[segments[s].first]; }
+    const Point& last(size_t s) const { return arena[segments[s].first + segments[s].count - 1]; }
+
+    uint64_t cellKey(const Point& p, int dx, int dy) const
+    {
+        return hashCombine(uint64_t(quantize(p.x, tolerance) + dx), uint64_t(quantize(p.y, tolerance) + dy));
+    }
+
+    double tolerance;
+    Polygon arena;
+    std::vector<Segment> segments;
+};
+
+} // namespace
+
+bool importDxf(std::istream& in, PartLibrary& library, const ImportOptions& options, std::string& error)
+{
+    if (!in) {
+        error = "cannot read DXF";
+        return false;
+    }
+
+    // The tolerance applies after scaling; curves are flattened before it
+    const double tolerance = options.scale != 0 ? options.tolerance / std::abs(options.scale) : options.tolerance;
+    const double joinTolerance = std::max(tolerance, 1e-9);
+    GroupReader reader(in);
+    RingSet rings;
+    SegmentChainer chainer(joinTolerance);
+    std::vector<std::string> layers;
+    std::unordered_map<std::string, uint32_t> layerIndex;
+    auto layerId = [&](const std::string& layer) {
+        auto found = layerIndex.find(layer);
+        if (found == layerIndex.end()) {
+            found = layerIndex.emplace(layer, uint32_t(layers.size())).first;
+            layers.push_back(layer);
+        }
+        return found->second;
+    };
+
+    Entity entity;
+    Entity polyline;      // An open POLYLINE collecting its VERTEX entities
+    bool inPolyline = false;
+    Polygon shape;
+
+    // A flattened shape: closed ones are rings now, open ones wait for chaining
+    auto emit = [&](const Entity& source, bool closed) {
+        if (source.mirrored) {
+            for (Point& p : shape) p.x = -p.x;
+        }
+        if (closed || (shape.size() >= 3 && isNear(shape.front(), shape.back(), joinTolerance))) {
+            rings.add(source.layer, shape);
+        } else {
+            chainer.add(layerId(source.layer), shape);
+        }
+    };
+    auto flattenPolyline = [&](const Entity& source) {
+        const Polygon& points = source.points;
+        if (points.empty()) return;
+        const bool closed = source.flags & 1;
+        shape.clear();
+        shape.push_back(points[0]);
+        const size_t segmentCount = closed ? points.size() : points.size() - 1;
+        for (size_t i = 0; i < segmentCount; ++i) {
+            const double bulge = i < source.bulges.size() ? source.bulges[i] : 0.0;
+            addBulgeSegment(points[i], points[(i + 1) % points.size()], bulge, tolerance, shape);
+        }
+        emit(source, closed);
+    };
+
+    auto finishEntity = [&]() {
+        const std::string& type = entity.type;
+        if (type == "LWPOLYLINE") {
+            flattenPolyline(entity);
+        } else if (type == "POLYLINE") {
+            // Meshes and polyface meshes have no outline
+            inPolyline = !(entity.flags & (16 | 64));
+            polyline = entity;
+            polyline.points.clear();
+            polyline.bulges.clear();
+        } else if (type == "VERTEX" && inPolyline) {
+            if (!entity.points.empty() && !(entity.flags & 16)) { // 16: spline frame control point
+                polyline.points.push_back(entity.points[0]);
+                polyline.bulges.push_back(entity.bulges.empty() ? 0.0 : entity.bulges[0]);
+            }
+        } else if (type == "SEQEND" && inPolyline) {
+            flattenPolyline(polyline);
+            inPolyline = false;
+        } else if ((type == "CIRCLE" || type == "ARC") && !entity.points.empty() && !entity.values40.empty()) {
+            const double radius = entity.values40[0];
+            if (radius <= 0) return;
+            const bool circle = type == "CIRCLE";
+            const double start = circle ? 0.0 : entity.startAngle * Pi / 180.0;
+            const double sweep = circle ? 2 * Pi : counterClockwiseSweep(start, entity.endAngle * Pi / 180.0, 2 * Pi);
+            const Point& center = entity.points[0];
+            shape.clear();
+            if (!circle) shape.push_back({center.x + radius * std::cos(start), center.y + radius * std::sin(start)});
+            flattenArc(center, radius, radius, 0, start, sweep, tolerance, shape);
+            if (circle) shape.pop_back(); // Back at the start
+            emit(entity, circle);
+        } else if (type == "ELLIPSE" && !entity.points.empty() && !entity.secondPoints.empty() && !entity.values40.empty()) {
+            const Point& center = entity.points[0];
+            const Point& major = entity.secondPoints[0];
+            const double rx = std::hypot(major.x, major.y);
+            const double start = entity.values41.empty() ? 0.0 : entity.values41[0];
+            const double sweep = counterClockwiseSweep(start, entity.value42, 2 * Pi);
+            if (rx <= 0) return;
+            const bool full = sweep > 2 * Pi - 1e-9;
+            const double rotation = std::atan2(major.y, major.x);
+            shape.clear();
+            if (!full) {
+                const double x = rx * std::cos(start);
+                const double y = rx * entity.values40[0] * std::sin(start);
+                shape.push_back({center.x + x * std::cos(rotation) - y * std::sin(rotation),
+                                 center.y + x * std::sin(rotation) + y * std::cos(rotation)});
+            }
+            flattenArc(center, rx, rx * entity.values40[0], rotation, start, sweep, tolerance, shape);
+            if (full) shape.pop_back();
+            entity.mirrored = false; // Ellipses are in world coordinates
+            emit(entity, full);
+        } else if (type == "LINE" && !entity.points.empty() && !entity.secondPoints.empty()) {
+            shape = {entity.points[0], entity.secondPoints[0]};
+            entity.mirrored = false;
+            emit(entity, false);
+        } else if (type == "SPLINE") {
+            const Spline spline(entity);
+            shape.clear();
+            if (spline.isValid()) {
+                spline.flatten(tolerance, shape);
+            } else {
+                shape = entity.secondPoints.empty() ? entity.points : entity.secondPoints; // Fit points, else the frame
+            }
+            entity.mirrored = false;
+            emit(entity, entity.flags & 1);
+        }
+    };
+
+    int code = 0;
+    std::string value;
+    bool sawSection = false;
+    bool inEntities = false;
+    bool expectSectionName = false;
+    double number = 0.0;
+    while (reader.next(code, value)) {
+        if (code == 0) {
+            if (inEntities) finishEntity();
+            entity.clear();
+            if (value == "SECTION") {
+                sawSection = true;
+                expectSectionName = true;
+            } else if (value == "ENDSEC") {
+                inEntities = false;
+            } else if (value == "EOF") {
+                break;
+            }
+            entity.type = value;
+            continue;
+        }
+        if (expectSectionName && code == 2) {
+            inEntities = value == "ENTITIES";
+            expectSectionName = false;
+            continue;
+        }
+        if (!inEntities) continue;
+
+        if (code == 8) {
+            entity.layer = value;
+            continue;
+        }
+        if (!toNumber(value, number)) continue;
+        switch (code) {
+        case 10: entity.points.push_back({number, 0.0}); break;
+        case 20: if (!entity.points.empty()) entity.points.back().y = number; break;
+        case 11: entity.secondPoints.push_back({number, 0.0}); break;
+        case 21: if (!entity.secondPoints.empty()) entity.secondPoints.back().y = number; break;
+        case 40: entity.values40.push_back(number); break;
+        case 41: entity.values41.push_back(number); break;
+        case 42:
+            if (entity.type == "LWPOLYLINE" || entity.type == "VERTEX") {
+                entity.bulges.resize(entity.points.size(), 0.0);
+                if (!entity.bulges.empty()) entity.bulges.back() = number;
+            } else {
+                entity.value42 = number;
+            }
+            break;
+        case 50: entity.startAngle = number; break;
+        case 51: entity.endAngle = number; break;
+        case 70: entity.flags = int(number); break;
+        case 71: entity.degree = int(number); break;
+        case 230: entity.mirrored = number < 0; break;
+        default: break;
+        }
+    }
+
+    if (!sawSection) {
+        error = "not an ASCII DXF file";
+        return false;
+    }
+    chainer.chain([&](uint32_t layer, Polygon& ring) { rings.add(layers[layer], ring); });
+    rings.addPartsTo(library, options.scale);
+    return true;
+}
+
+} // namespace nest
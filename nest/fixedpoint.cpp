@@ -0,0 +1,163 @@
+#include "fixedpoint.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace nest {
+
+static std::atomic<double> resolution{0.0};
+
+void setGridResolution(double value)
+{
+    resolution.store(value > 0 && std::isfinite(value) ? value : 0.0, std::memory_order_relaxed);
+}
+
+double gridResolution()
+{
+    return resolution.load(std::memory_order_relaxed);
+}
+
+bool gridEnabled()
+{
+    return gridResolution() > 0;
+}
+
+static int64_t toGrid(double value, double step)
+{
+    const double scaled = std::round(value / step);
+    if (!(scaled < double(MaxGridCoordinate))) return scaled != scaled ? 0 : MaxGridCoordinate;
+    if (!(scaled > -double(MaxGridCoordinate))) return -MaxGridCoordinate;
+    return int64_t(scaled);
+}
+
+FixedPoint toFixed(const Point& p)
+{
+    const double step = gridResolution();
+    return {toGrid(p.x, step), toGrid(p.y, step)};
+}
+
+Point fromFixed(const FixedPoint& p)
+{
+    const double step = gridResolution();
+    return {double(p.x) * step, double(p.y) * step};
+}
+
+Point snapped(const Point& p)
+{
+    return gridEnabled() ? fromFixed(toFixed(p)) : p;
+}
+
+void snapToGrid(Polygon& poly)
+{
+    if (!gridEnabled()) return;
+    size_t kept = 0;
+    for (const Point& p : poly) {
+        const Point q = fromFixed(toFixed(p));
+        if (kept == 0 || poly[kept - 1] != q) poly[kept++] = q;
+    }
+    poly.resize(kept);
+    while (poly.size() > 1 && poly.front() == poly.back()) poly.pop_back();
+}
+
+#if !defined(__SIZEOF_INT128__)
+// Sign of a * b - c * d without a 128-bit type: magnitudes multiplied from
+// 32-bit halves, then compared with their signs
+namespace {
+
+struct Wide
+{
+    bool negative = false;
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+};
+
+Wide multiply(int64_t a, int64_t b)
+{
+    Wide w;
+    const uint64_t x = a < 0 ? 0 - uint64_t(a) : uint64_t(a);
+    const uint64_t y = b < 0 ? 0 - uint64_t(b) : uint64_t(b);
+    const uint64_t x0 = x & 0xffffffffu, x1 = x >> 32;
+    const uint64_t y0 = y & 0xffffffffu, y1 = y >> 32;
+    const uint64_t p00 = x0 * y0, p01 = x0 * y1, p10 = x1 * y0, p11 = x1 * y1;
+    const uint64_t middle = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+    w.lo = (middle << 32) | (p00 & 0xffffffffu);
+    w.hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+    w.negative = (a < 0) != (b < 0) && (w.hi || w.lo);
+    return w;
+}
+
+int compareMagnitude(const Wide& l, const Wide& r)
+{
+    if (l.hi != r.hi) return l.hi < r.hi ? -1 : 1;
+    if (l.lo != r.lo) return l.lo < r.lo ? -1 : 1;
+    return 0;
+}
+
+int compareProducts(int64_t a, int64_t b, int64_t c, int64_t d)
+{
+    const Wide l = multiply(a, b);
+    const Wide r = multiply(c, d);
+    if (l.negative != r.negative) return l.negative ? -1 : 1;
+    const int magnitude = compareMagnitude(l, r);
+    return l.negative ? -magnitude : magnitude;
+}
+
+} // namespace
+#endif
+
+int orientation(const FixedPoint& o, const FixedPoint& a, const FixedPoint& b)
+{
+    const int64_t ax = a.x - o.x, ay = a.y - o.y;
+    const int64_t bx = b.x - o.x, by = b.y - o.y;
+    // Small coordinates, the usual case, fit 64-bit products exactly
+    const int64_t small = int64_t(1) << 31;
+    if (ax > -small && ax < small && ay > -small && ay < small && bx > -small && bx < small && by > -small &&
+        by < small) {
+        const int64_t l = ax * by, r = ay * bx;
+        return (l > r) - (l < r);
+    }
+#if defined(__SIZEOF_INT128__)
+    const __int128 l = __int128(ax) * by, r = __int128(ay) * bx;
+    return (l > r) - (l < r);
+#else
+    return compareProducts(ax, by, ay, bx);
+#endif
+}
+
+int orientation(const Point& o, const Point& a, const Point& b)
+{
+    if (gridEnabled()) return orientation(toFixed(o), toFixed(a), toFixed(b));
+    const double cross = crossProduct(o, a, b);
+    return (cross > 0) - (cross < 0);
+}
+
+template <typename Vertex>
+static Location locateImpl(size_t n, Vertex&& vertex, const FixedPoint& p)
+{
+    bool inside = false;
+    FixedPoint b = n ? vertex(n - 1) : FixedPoint();
+    for (size_t i = 0; i < n; ++i) {
+        const FixedPoint a = vertex(i);
+        const int side = orientation(a, b, p);
+        if (side == 0 && p.x >= std::min(a.x, b.x) && p.x <= std::max(a.x, b.x) && p.y >= std::min(a.y, b.y) &&
+            p.y <= std::max(a.y, b.y)) {
+            return Location::Boundary;
+        }
+        // Half-open in y, so a crossing through a vertex counts once
+        if ((a.y > p.y) != (b.y > p.y) && ((b.y > a.y) ? side > 0 : side < 0)) inside = !inside;
+        b = a;
+    }
+    return inside ? Location::Inside : Location::Outside;
+}
+
+Location locate(const std::vector<FixedPoint>& poly, const FixedPoint& p)
+{
+    return locateImpl(poly.size(), [&poly](size_t i) { return poly[i]; }, p);
+}
+
+Location locateOnGrid(const Polygon& poly, const Point& p)
+{
+    return locateImpl(poly.size(), [&poly](size_t i) { return toFixed(poly[i]); }, toFixed(p));
+}
+
+} // namespace nest
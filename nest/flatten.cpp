@@ -0,0 +1,92 @@
+#include "flatten.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+static const int MaxSegments = 4096;
+
+static double length(const Point& p)
+{
+    return std::hypot(p.x, p.y);
+}
+
+// Wang's bound: n chords keep a polynomial curve within tolerance if
+// n^2 >= max|B''| / (8 tolerance)
+static int segmentsFor(double secondDerivative, double tolerance)
+{
+    if (!(tolerance > 0) || !(secondDerivative > 0)) return secondDerivative > 0 ? MaxSegments : 1;
+    const double n = std::ceil(std::sqrt(secondDerivative / (8.0 * tolerance)));
+    return int(std::min<double>(std::max(1.0, n), MaxSegments));
+}
+
+void flattenQuadratic(const Point& p0, const Point& p1, const Point& p2, double tolerance, Polygon& out)
+{
+    const int n = segmentsFor(2.0 * length(p0 - p1 * 2.0 + p2), tolerance);
+    for (int i = 1; i < n; ++i) {
+        const double t = double(i) / n;
+        const double s = 1.0 - t;
+        out.push_back(p0 * (s * s) + p1 * (2.0 * s * t) + p2 * (t * t));
+    }
+    out.push_back(p2);
+}
+
+void flattenCubic(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double tolerance, Polygon& out)
+{
+    const double bend = std::max(length(p0 - p1 * 2.0 + p2), length(p1 - p2 * 2.0 + p3));
+    const int n = segmentsFor(6.0 * bend, tolerance);
+    for (int i = 1; i < n; ++i) {
+        const double t = double(i) / n;
+        const double s = 1.0 - t;
+        out.push_back(p0 * (s * s * s) + p1 * (3.0 * s * s * t) + p2 * (3.0 * s * t * t) + p3 * (t * t * t));
+    }
+    out.push_back(p3);
+}
+
+void flattenArc(const Point& center, double rx, double ry, double rotation, double start, double sweep, double tolerance,
+                Polygon& out)
+{
+    // A chord of angle a on a circle of radius r strays r (1 - cos(a / 2)) from it
+    const double radius = std::max(std::abs(rx), std::abs(ry));
+    int n = MaxSegments;
+    if (tolerance > 0 && tolerance < radius) {
+        const double step = 2.0 * std::acos(1.0 - tolerance / radius);
+        n = int(std::min<double>(std::ceil(std::abs(sweep) / step), MaxSegments));
+    } else if (tolerance >= radius) {
+        n = 1;
+    }
+    n = std::max(n, std::abs(sweep) > Pi ? 3 : 1); // A closed loop needs a triangle at least
+
+    const double c = std::cos(rotation);
+    const double s = std::sin(rotation);
+    for (int i = 1; i <= n; ++i) {
+        const double angle = start + sweep * i / n;
+        const double x = rx * std::cos(angle);
+        const double y = ry * std::sin(angle);
+        out.push_back({center.x + x * c - y * s, center.y + x * s + y * c});
+    }
+}
+
+static void subdivide(const std::function<Point(double)>& curve, double t0, const Point& a, double t1, const Point& b,
+                      double tolerance, int depth, Polygon& out)
+{
+    const double tm = 0.5 * (t0 + t1);
+    const Point m = curve(tm);
+    const Point chord = b - a;
+    const double chordLength = length(chord);
+    const double deviation = chordLength > 0 ? std::abs(crossProduct(a, b, m)) / chordLength : length(m - a);
+    // Also split the first levels, so an S bend with its midpoint on the chord is not missed
+    if (depth < 12 && (depth < 2 || deviation > tolerance)) {
+        subdivide(curve, t0, a, tm, m, tolerance, depth + 1, out);
+        subdivide(curve, tm, m, t1, b, tolerance, depth + 1, out);
+    } else {
+        out.push_back(b);
+    }
+}
+
+void flattenCurve(const std::function<Point(double)>& curve, double t0, double t1, double tolerance, Polygon& out)
+{
+    subdivide(curve, t0, curve(t0), t1, curve(t1), tolerance, 0, out);
+}
+
+} // namespace nest
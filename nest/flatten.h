@@ -0,0 +1,29 @@
+#ifndef NEST_FLATTEN_H
+#define NEST_FLATTEN_H
+
+#include "geometry.h"
+#include <functional>
+
+// Curves to polylines that stay within a distance tolerance of the curve.
+// Each function appends the points after the start point, ending with the
+// end point, so consecutive segments chain without repeated vertices.
+// Segment counts are capped, so a tiny tolerance cannot run away.
+namespace nest {
+
+void flattenQuadratic(const Point& p0, const Point& p1, const Point& p2, double tolerance, Polygon& out);
+void flattenCubic(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double tolerance, Polygon& out);
+
+// Elliptical arc about center with radii rx and ry, its x axis at rotation
+// radians, from angle start through sweep radians (negative is clockwise in
+// a y-up frame). Angles are the ellipse's parametric angles.
+void flattenArc(const Point& center, double rx, double ry, double rotation, double start, double sweep, double tolerance,
+                Polygon& out);
+
+// Any curve, by recursive subdivision until each chord's midpoint lies
+// within tolerance of the curve. For splines and other curves without a
+// closed form bound.
+void flattenCurve(const std::function<Point(double)>& curve, double t0, double t1, double tolerance, Polygon& out);
+
+} // namespace nest
+
+#endif // NEST_FLATTEN_H
@@ -0,0 +1,235 @@
+#include "geometry.h"
+#include "fixedpoint.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+Rect Rect::united(const Rect& other) const
+{
+    if (isEmpty()) return other;
+    if (other.isEmpty()) return *this;
+    return {std::min(minX, other.minX), std::min(minY, other.minY),
+            std::max(maxX, other.maxX), std::max(maxY, other.maxY)};
+}
+
+Rect Rect::translated(const Point& offset) const
+{
+    if (isEmpty()) return *this;
+    return {minX + offset.x, minY + offset.y, maxX + offset.x, maxY + offset.y};
+}
+
+bool Rect::intersects(const Rect& other) const
+{
+    if (isEmpty() || other.isEmpty()) return false;
+    return minX < other.maxX && other.minX < maxX && minY < other.maxY && other.minY < maxY;
+}
+
+bool Rect::contains(const Point& p) const
+{
+    return !isEmpty() && p.x >= minX && p.x <= maxX && p.y >= minY && p.y <= maxY;
+}
+
+double signedArea(const Polygon& poly)
+{
+    double area = 0.0;
+    const size_t n = poly.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = poly[i];
+        const Point& b = poly[(i + 1) % n];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area * 0.5;
+}
+
+Rect boundingRect(const Polygon& poly)
+{
+    if (poly.empty()) return Rect();
+    Rect r{poly[0].x, poly[0].y, poly[0].x, poly[0].y};
+    for (const Point& p : poly) {
+        r.minX = std::min(r.minX, p.x);
+        r.minY = std::min(r.minY, p.y);
+        r.maxX = std::max(r.maxX, p.x);
+        r.maxY = std::max(r.maxY, p.y);
+    }
+    return r;
+}
+
+Point rotated(const Point& p, double rotation)
+{
+    const double rad = rotation * Pi / 180.0;
+    const double c = std::cos(rad);
+    const double s = std::sin(rad);
+    return {p.x * c - p.y * s, p.x * s + p.y * c};
+}
+
+Polygon transformed(const Polygon& poly, double rotation, double scale, const Point& offset)
+{
+    Polygon out;
+    transform(poly, rotation, scale, offset, out);
+    return out;
+}
+
+void transform(const Polygon& poly, double rotation, double scale, const Point& offset, Polygon& out)
+{
+    const double rad = rotation * Pi / 180.0;
+    const double c = std::cos(rad) * scale;
+    const double s = std::sin(rad) * scale;
+    out.resize(poly.size());
+    for (size_t i = 0; i < poly.size(); ++i) {
+        const Point& p = poly[i];
+        out[i] = {p.x * c - p.y * s + offset.x, p.x * s + p.y * c + offset.y};
+    }
+}
+
+bool containsPoint(const Polygon& poly, const Point& p)
+{
+    if (gridEnabled()) return locateOnGrid(poly, p) == Location::Inside;
+    bool inside = false;
+    const size_t n = poly.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const Point& a = poly[i];
+        const Point& b = poly[j];
+        if ((a.y > p.y) != (b.y > p.y)) {
+            const double x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (p.x < x) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool isConvex(const Polygon& poly)
+{
+    const size_t n = poly.size();
+    if (n < 3) return false;
+    int sign = 0;
+    double turning = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = poly[i];
+        const Point& b = poly[(i + 1) % n];
+        const Point& c = poly[(i + 2) % n];
+        const int s = orientation(a, b, c);
+        if (s != 0) {
+            if (sign != 0 && s != sign) return false;
+            sign = s;
+        }
+        // Accumulate exterior angles so self-overlapping windings (pentagrams) are rejected
+        const Point u = b - a;
+        const Point v = c - b;
+        turning += std::atan2(u.x * v.y - u.y * v.x, u.x * v.x + u.y * v.y);
+    }
+    return sign != 0 && std::abs(std::abs(turning) - 2 * Pi) < 1e-6;
+}
+
+// Relative tolerance for symmetric vertices, far inside the collision tests'
+// touching distance for any sensible part size
+static const double kSymmetryEpsilon = 1e-10;
+
+int rotationalSymmetry(const Polygon& poly, Point& center)
+{
+    center = Point();
+    const size_t n = poly.size();
+    if (n < 3) return 1;
+    double twiceArea = 0.0;
+    Point sum;
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = poly[i];
+        const Point& b = poly[(i + 1) % n];
+        const double cross = a.x * b.y - b.x * a.y;
+        twiceArea += cross;
+        sum = sum + (a + b) * cross;
+    }
+    if (twiceArea == 0) return 1;
+    const Point c = sum * (1.0 / (3.0 * twiceArea));
+    const Rect box = boundingRect(poly);
+    const double tolerance = kSymmetryEpsilon * std::max(box.width(), box.height());
+    auto near = [tolerance](const Point& a, const Point& b) {
+        return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance;
+    };
+
+    // A symmetry keeps the boundary's order, so it shifts the vertex indices
+    // by a multiple of n/k. The highest order found generates all the others.
+    for (size_t k = n; k >= 2; --k) {
+        if (n % k != 0) continue;
+        const double turn = 360.0 / double(k);
+        const Point first = c + rotated(poly[0] - c, turn);
+        for (size_t shift = n / k; shift < n; shift += n / k) {
+            if (!near(first, poly[shift])) continue;
+            size_t i = 1;
+            while (i < n && near(c + rotated(poly[i] - c, turn), poly[(i + shift) % n])) ++i;
+            if (i == n) {
+                center = c;
+                return int(k);
+            }
+        }
+    }
+    return 1;
+}
+
+// Relative tolerance for treating consecutive edges as collinear
+static const double kCollinearEpsilon = 1e-12;
+
+static bool isCollinear(const Point& a, const Point& b, const Point& c)
+{
+    if (gridEnabled()) return orientation(a, b, c) == 0;
+    const Point u = b - a;
+    const Point v = c - b;
+    const double scale = (std::abs(u.x) + std::abs(u.y)) * (std::abs(v.x) + std::abs(v.y));
+    return std::abs(u.x * v.y - u.y * v.x) <= kCollinearEpsilon * scale;
+}
+
+void removeCollinear(Polygon& poly)
+{
+    Polygon out;
+    out.reserve(poly.size());
+    for (const Point& p : poly) {
+        if (out.empty() || out.back() != p) out.push_back(p);
+    }
+    while (out.size() > 1 && out.front() == out.back()) out.pop_back();
+
+    bool changed = true;
+    while (changed && out.size() >= 3) {
+        changed = false;
+        for (size_t i = 0; i < out.size() && out.size() >= 3; ++i) {
+            const size_t prev = (i + out.size() - 1) % out.size();
+            const size_t next = (i + 1) % out.size();
+            if (isCollinear(out[prev], out[i], out[next])) {
+                out.erase(out.begin() + i);
+                changed = true;
+                --i;
+            }
+        }
+    }
+    poly.swap(out);
+}
+
+Polygon convexHull(Polygon points)
+{
+    if (points.size() <= 3) return points; // If 3 or fewer points, it's already a convex hull
+
+    // Sort points lexicographically (by x-coordinate, then y-coordinate)
+    std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+        return (a.x < b.x) || (a.x == b.x && a.y < b.y);
+    });
+
+    // Lower hull then upper hull in one buffer; k is the hull's end
+    Polygon hull(2 * points.size());
+    size_t k = 0;
+    for (const Point& p : points) {
+        while (k >= 2 && orientation(hull[k - 2], hull[k - 1], p) <= 0) --k; // Drop non-left turns
+        hull[k++] = p;
+    }
+    // The upper hull starts from the last point, already on the lower one
+    const size_t lowerEnd = k + 1;
+    for (size_t i = points.size() - 1; i-- > 0;) {
+        const Point& p = points[i];
+        while (k >= lowerEnd && orientation(hull[k - 2], hull[k - 1], p) <= 0) --k;
+        hull[k++] = p;
+    }
+
+    // The upper hull ends on the first point again
+    hull.resize(k - 1);
+    return hull;
+}
+
+} // namespace nest
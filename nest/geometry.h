@@ -0,0 +1,84 @@
+#ifndef NEST_GEOMETRY_H
+#define NEST_GEOMETRY_H
+
+#include <vector>
+
+// Plain geometry types used by the nesting engine. They deliberately do not
+// depend on Qt so the engine can run in batch jobs and tests without a
+// QApplication; the GUI converts to and from QPolygonF at its boundary.
+namespace nest {
+
+constexpr double Pi = 3.14159265358979323846;
+
+struct Point
+{
+    double x = 0.0;
+    double y = 0.0;
+};
+
+inline Point operator+(const Point& a, const Point& b) { return {a.x + b.x, a.y + b.y}; }
+inline Point operator-(const Point& a, const Point& b) { return {a.x - b.x, a.y - b.y}; }
+inline Point operator-(const Point& a) { return {-a.x, -a.y}; }
+inline Point operator*(const Point& a, double s) { return {a.x * s, a.y * s}; }
+inline bool operator==(const Point& a, const Point& b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(const Point& a, const Point& b) { return !(a == b); }
+
+using Polygon = std::vector<Point>;
+
+// Axis-aligned bounding box. A default constructed Rect is empty.
+struct Rect
+{
+    double minX = 0.0;
+    double minY = 0.0;
+    double maxX = -1.0;
+    double maxY = -1.0;
+
+    bool isEmpty() const { return maxX < minX || maxY < minY; }
+    double width() const { return isEmpty() ? 0.0 : maxX - minX; }
+    double height() const { return isEmpty() ? 0.0 : maxY - minY; }
+    double area() const { return width() * height(); }
+    Point center() const { return {(minX + maxX) * 0.5, (minY + maxY) * 0.5}; }
+
+    Rect united(const Rect& other) const;
+    Rect translated(const Point& offset) const;
+    bool intersects(const Rect& other) const;
+    bool contains(const Point& p) const;
+};
+
+// Cross product of vectors OA and OB, positive for a counter-clockwise turn
+// in a y-up frame (clockwise on screen, where y points down).
+inline double crossProduct(const Point& O, const Point& A, const Point& B)
+{
+    return (A.x - O.x) * (B.y - O.y) - (A.y - O.y) * (B.x - O.x);
+}
+
+double signedArea(const Polygon& poly);
+Rect boundingRect(const Polygon& poly);
+
+// Rotate (degrees, same convention as QTransform::rotate) and uniformly scale
+// about the origin, then translate by offset.
+Polygon transformed(const Polygon& poly, double rotation, double scale, const Point& offset = Point());
+// The same written into out, reusing its buffer
+void transform(const Polygon& poly, double rotation, double scale, const Point& offset, Polygon& out);
+Point rotated(const Point& p, double rotation);
+
+// Odd-even fill rule, matching QPolygonF::containsPoint(p, Qt::OddEvenFill).
+bool containsPoint(const Polygon& poly, const Point& p);
+
+// True for a simple convex polygon in either winding; collinear vertices allowed
+bool isConvex(const Polygon& poly);
+
+// Drop repeated and collinear vertices in place, treating poly as closed
+void removeCollinear(Polygon& poly);
+
+// Order k of poly's rotational symmetry: a turn of 360/k degrees about center
+// (the area centroid) maps its vertices onto each other, to within 1e-10 of
+// its size. 1, with center left at the origin, if there is none.
+int rotationalSymmetry(const Polygon& poly, Point& center);
+
+// Andrew's monotone chain, counter-clockwise in a y-up frame.
+Polygon convexHull(Polygon points);
+
+} // namespace nest
+
+#endif // NEST_GEOMETRY_H
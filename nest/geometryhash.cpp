@@ -0,0 +1,28 @@
+#include "geometryhash.h"
+#include <algorithm>
+
+namespace nest {
+
+uint64_t geometryHash(const Polygon& input)
+{
+    Polygon poly = input;
+    removeCollinear(poly);
+    if (signedArea(poly) < 0) std::reverse(poly.begin(), poly.end());
+
+    // Start at the lowest quantized vertex
+    auto lowest = std::min_element(poly.begin(), poly.end(), [](const Point& a, const Point& b) {
+        const int64_t ay = quantize(a.y);
+        const int64_t by = quantize(b.y);
+        return ay < by || (ay == by && quantize(a.x) < quantize(b.x));
+    });
+    std::rotate(poly.begin(), lowest, poly.end());
+
+    uint64_t hash = hashMix(poly.size());
+    for (const Point& p : poly) {
+        hash = hashCombine(hash, uint64_t(quantize(p.x)));
+        hash = hashCombine(hash, uint64_t(quantize(p.y)));
+    }
+    return hash;
+}
+
+} // namespace nest
@@ -0,0 +1,40 @@
+#ifndef NEST_GEOMETRYHASH_H
+#define NEST_GEOMETRYHASH_H
+
+#include "geometry.h"
+#include <cstdint>
+
+namespace nest {
+
+// Coordinates are quantized to this grid before hashing
+constexpr double HashResolution = 1e-6;
+
+inline uint64_t hashMix(uint64_t x)
+{
+    // splitmix64 finalizer
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value)
+{
+    return hashMix(seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2)));
+}
+
+inline int64_t quantize(double value, double resolution = HashResolution)
+{
+    return int64_t(value >= 0 ? value / resolution + 0.5 : value / resolution - 0.5);
+}
+
+// Hash of an outline that ignores where the vertex list starts and which way
+// it winds, so the same geometry entered twice hashes the same. Position
+// relative to the local origin is part of the geometry, since NFPs depend on it.
+uint64_t geometryHash(const Polygon& poly);
+
+} // namespace nest
+
+#endif // NEST_GEOMETRYHASH_H
@@ -0,0 +1,132 @@
+#include "importsupport.h"
+#include "spatialgrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+bool parseNumber(const char*& p, const char* end, double& value)
+{
+    const char* s = p;
+    bool negative = false;
+    if (s < end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    bool digits = false;
+    for (; s < end && *s >= '0' && *s <= '9'; ++s) {
+        mantissa = mantissa * 10.0 + (*s - '0');
+        digits = true;
+    }
+    if (s < end && *s == '.') {
+        for (++s; s < end && *s >= '0' && *s <= '9'; ++s) {
+            mantissa = mantissa * 10.0 + (*s - '0');
+            --exponent;
+            digits = true;
+        }
+    }
+    if (!digits) return false;
+
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        const char* e = s + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) negativeExponent = *e++ == '-';
+        if (e < end && *e >= '0' && *e <= '9') {
+            int power = 0;
+            for (; e < end && *e >= '0' && *e <= '9'; ++e) power = std::min(power * 10 + (*e - '0'), 9999);
+            exponent += negativeExponent ? -power : power;
+            s = e;
+        }
+    }
+
+    value = exponent ? mantissa * std::pow(10.0, exponent) : mantissa;
+    if (negative) value = -value;
+    p = s;
+    return std::isfinite(value);
+}
+
+void RingSet::add(const std::string& name, Polygon& ring)
+{
+    if (ring.size() > 1 && ring.front() == ring.back()) ring.pop_back();
+    removeCollinear(ring);
+    if (ring.size() < 3) return;
+    const double area = std::abs(signedArea(ring));
+    if (!(area > 0)) return;
+
+    Ring entry;
+    entry.box = boundingRect(ring);
+    entry.offset = {entry.box.minX, entry.box.minY};
+    entry.area = area;
+    entry.outline = outlines.add(name, ring);
+    rings.push_back(entry);
+}
+
+void RingSet::addPartsTo(PartLibrary& library, double scale) const
+{
+    if (rings.empty()) return;
+
+    // Cells about the size of a typical ring keep the containment queries local
+    double sideSum = 0.0;
+    for (const Ring& ring : rings) sideSum += std::max(ring.box.width(), ring.box.height());
+    SpatialGrid grid(std::max(sideSum / rings.size(), 1e-9));
+    for (size_t i = 0; i < rings.size(); ++i) grid.insert(int(i), rings[i].box);
+
+    // Depth is how many larger rings contain a ring's first vertex. Rings
+    // of a well formed file do not cross, so one vertex decides, and the
+    // smallest of them is the ring's parent.
+    const size_t none = size_t(-1);
+    std::vector<int> depths(rings.size(), 0);
+    std::vector<size_t> parents(rings.size(), none);
+    Polygon outline;
+    for (size_t i = 0; i < rings.size(); ++i) {
+        const Ring& ring = rings[i];
+        const Point probe = outlines.vertices(ring.outline)[0] + ring.offset;
+        grid.query({probe.x, probe.y, probe.x, probe.y}, [&](int id) {
+            const Ring& other = rings[size_t(id)];
+            if (&other == &ring || other.area <= ring.area) return;
+            const Point* first = outlines.vertices(other.outline);
+            outline.assign(first, first + outlines.entry(other.outline).count);
+            if (!containsPoint(outline, probe - other.offset)) return;
+            ++depths[i];
+            if (parents[i] == none || other.area < rings[parents[i]].area) parents[i] = size_t(id);
+        });
+    }
+
+    // Rings at odd depth are holes of their parent
+    std::vector<std::vector<size_t>> holes(rings.size());
+    for (size_t i = 0; i < rings.size(); ++i) {
+        if (depths[i] % 2 == 1) holes[parents[i]].push_back(i);
+    }
+
+    // Parts without holes are counted per outline; each framed one is added
+    // with its holes, in its outline's coordinates
+    std::vector<int> quantities(outlines.size(), 0);
+    std::vector<Polygon> partHoles;
+    for (size_t i = 0; i < rings.size(); ++i) {
+        const Ring& ring = rings[i];
+        if (depths[i] % 2 == 1) continue;
+        if (holes[i].empty()) {
+            ++quantities[ring.outline];
+            continue;
+        }
+        partHoles.clear();
+        for (size_t h : holes[i]) {
+            partHoles.push_back(outlines.outline(rings[h].outline));
+            for (Point& p : partHoles.back()) p = (p + rings[h].offset - ring.offset) * scale;
+        }
+        outline = outlines.outline(ring.outline);
+        for (Point& p : outline) p = p * scale;
+        library.add(outlines.entry(ring.outline).name, outline, 1, partHoles);
+    }
+
+    for (size_t i = 0; i < outlines.size(); ++i) {
+        if (!quantities[i]) continue;
+        outline = outlines.outline(i);
+        if (scale != 1.0) {
+            for (Point& p : outline) p = p * scale;
+        }
+        library.add(outlines.entry(i).name, outline, quantities[i]);
+    }
+}
+
+} // namespace nest
@@ -0,0 +1,49 @@
+#ifndef NEST_IMPORTSUPPORT_H
+#define NEST_IMPORTSUPPORT_H
+
+#include "partlibrary.h"
+#include <string>
+#include <vector>
+
+// Pieces shared by the SVG and DXF importers
+namespace nest {
+
+// Reads a decimal number at p, advancing past it: optional sign, digits,
+// fraction and exponent. Locale independent, unlike strtod once a GUI has
+// called setlocale, and stops where SVG's compact "1.5-2.5.5" runs split.
+bool parseNumber(const char*& p, const char* end, double& value);
+
+// Closed outlines gathered while a file is read. Which rings are parts is
+// only known at the end: a ring inside another is a hole of that part, and
+// a ring inside a hole is a part again. So each ring's geometry goes into a
+// deduplicated library straight away and only its place in the drawing is
+// kept per ring, which keeps memory flat for files of repeated parts.
+class RingSet
+{
+public:
+    // Cleans up ring in place first: drops a repeated closing vertex and
+    // collinear vertices. Rings left without area are skipped.
+    void add(const std::string& name, Polygon& ring);
+
+    // Adds the rings at even nesting depth, scaled, to library, each with
+    // the rings directly inside it as holes
+    void addPartsTo(PartLibrary& library, double scale) const;
+
+    size_t size() const { return rings.size(); }
+
+private:
+    struct Ring
+    {
+        size_t outline = 0; // Entry in outlines
+        Point offset;       // Where the outline's bounding box starts in the drawing
+        Rect box;
+        double area = 0.0;
+    };
+
+    PartLibrary outlines;
+    std::vector<Ring> rings;
+};
+
+} // namespace nest
+
+#endif // NEST_IMPORTSUPPORT_H
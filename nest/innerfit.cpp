@@ -0,0 +1,138 @@
+#include "innerfit.h"
+#include "decomposition.h"
+#include "fixedpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace nest {
+
+// Slack for points on a clipping line, so exact fits survive as segments or points
+static const double kEpsilon = 1e-9;
+
+// Distance from p to segment ab
+static double segmentDistance(const Point& p, const Point& a, const Point& b)
+{
+    const Point ab = b - a;
+    const double len2 = ab.x * ab.x + ab.y * ab.y;
+    double t = len2 > 0 ? ((p.x - a.x) * ab.x + (p.y - a.y) * ab.y) / len2 : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    const Point d = p - (a + ab * t);
+    return std::hypot(d.x, d.y);
+}
+
+bool InnerFit::contains(const Point& p) const
+{
+    for (const Polygon& region : regions) {
+        const size_t n = region.size();
+        if (n < 3) {
+            // Degenerate fit: a point or a segment
+            if (segmentDistance(p, region.front(), region.back()) <= kEpsilon) return true;
+            continue;
+        }
+        bool inside = true;
+        for (size_t i = 0; i < n && inside; ++i) {
+            const Point& a = region[i];
+            const Point& b = region[(i + 1) % n];
+            inside = crossProduct(a, b, p) >= -kEpsilon * std::hypot(b.x - a.x, b.y - a.y);
+        }
+        if (inside) return true;
+    }
+    return false;
+}
+
+Rect innerFitRect(const Rect& region, const Rect& bounds)
+{
+    if (region.isEmpty() || bounds.isEmpty()) return Rect();
+    const Rect fit{region.minX - bounds.minX, region.minY - bounds.minY, region.maxX - bounds.maxX,
+                   region.maxY - bounds.maxY};
+    return fit.isEmpty() ? Rect() : fit;
+}
+
+bool clampInto(const Rect& fit, Point& p, double tolerance)
+{
+    if (gridEnabled()) tolerance = 0.0; // Points there are exact, and clamping could leave the grid
+    if (fit.isEmpty() || p.x < fit.minX - tolerance || p.x > fit.maxX + tolerance || p.y < fit.minY - tolerance ||
+        p.y > fit.maxY + tolerance) {
+        return false;
+    }
+    p.x = std::min(fit.maxX, std::max(fit.minX, p.x));
+    p.y = std::min(fit.maxY, std::max(fit.minY, p.y));
+    return true;
+}
+
+Rect stripRegion(double height)
+{
+    const double infinity = std::numeric_limits<double>::infinity();
+    return {-infinity, 0.0, infinity, height};
+}
+
+Polygon innerFitConvex(const Polygon& container, const Polygon& moving)
+{
+    if (container.size() < 3 || moving.empty()) return Polygon();
+    const Rect outer = boundingRect(container);
+    const Rect part = boundingRect(moving);
+
+    // Start from the box-in-box fit, which contains the IFP
+    const Rect start{outer.minX - part.minX, outer.minY - part.minY, outer.maxX - part.maxX, outer.maxY - part.maxY};
+    if (start.maxX < start.minX - kEpsilon || start.maxY < start.minY - kEpsilon) return Polygon();
+    Polygon region{{start.minX, start.minY}, {std::max(start.minX, start.maxX), start.minY},
+                   {std::max(start.minX, start.maxX), std::max(start.minY, start.maxY)},
+                   {start.minX, std::max(start.minY, start.maxY)}};
+
+    const double winding = signedArea(container) > 0 ? 1.0 : -1.0;
+    const size_t n = container.size();
+    Polygon clipped;
+    for (size_t i = 0; i < n && !region.empty(); ++i) {
+        const Point& a = container[i];
+        const Point& b = container[(i + 1) % n];
+        const Point edge = (b - a) * winding;
+        const double length = std::hypot(edge.x, edge.y);
+        if (length == 0.0) continue;
+
+        // moving + p stays left of the edge iff f(p) >= 0
+        double reach = std::numeric_limits<double>::max();
+        for (const Point& v : moving) reach = std::min(reach, edge.x * v.y - edge.y * v.x);
+        auto f = [&](const Point& p) { return edge.x * (p.y - a.y) - edge.y * (p.x - a.x) + reach; };
+        const double tolerance = kEpsilon * length;
+
+        // Sutherland-Hodgman against one half-plane
+        clipped.clear();
+        for (size_t j = 0; j < region.size(); ++j) {
+            const Point& current = region[j];
+            const Point& previous = region[(j + region.size() - 1) % region.size()];
+            const double fc = f(current);
+            const double fp = f(previous);
+            const bool currentIn = fc >= -tolerance;
+            const bool previousIn = fp >= -tolerance;
+            if (currentIn != previousIn) {
+                const double t = std::max(0.0, std::min(1.0, fp / (fp - fc)));
+                clipped.push_back(previous + (current - previous) * t);
+            }
+            if (currentIn) clipped.push_back(current);
+        }
+        region.swap(clipped);
+    }
+
+    // Drop the repeats left by degenerate fits
+    Polygon result;
+    for (const Point& p : region) {
+        if (result.empty() || std::hypot(p.x - result.back().x, p.y - result.back().y) > kEpsilon) result.push_back(p);
+    }
+    while (result.size() > 1 && std::hypot(result.front().x - result.back().x, result.front().y - result.back().y) <= kEpsilon) {
+        result.pop_back();
+    }
+    return result;
+}
+
+InnerFit computeInnerFit(const Polygon& container, const Polygon& moving)
+{
+    InnerFit ifp;
+    for (const Polygon& piece : convexDecomposition(container)) {
+        Polygon region = innerFitConvex(piece, moving);
+        if (!region.empty()) ifp.regions.push_back(std::move(region));
+    }
+    return ifp;
+}
+
+} // namespace nest
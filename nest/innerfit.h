@@ -0,0 +1,45 @@
+#ifndef NEST_INNERFIT_H
+#define NEST_INNERFIT_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// Inner-fit polygon: the reference points p at which moving + p lies inside a
+// container such as a hole. Regions are convex and counter-clockwise, and may
+// degenerate to a segment or a single point when the part fits exactly.
+struct InnerFit
+{
+    std::vector<Polygon> regions;
+
+    bool isEmpty() const { return regions.empty(); }
+    bool contains(const Point& p) const;
+};
+
+// Exact IFP for a convex container: one half-plane per container edge,
+// pulled in by the moving part's extent along that edge's normal.
+Polygon innerFitConvex(const Polygon& container, const Polygon& moving);
+
+// Reference points at which a part with the given bounds, relative to its
+// reference point, lies inside a rectangular region such as a sheet. Exact,
+// since a polygon is inside a rectangle iff its bounding box is. Infinite
+// region sides stay infinite; empty if the part cannot fit.
+Rect innerFitRect(const Rect& region, const Rect& bounds);
+
+// Moves p onto fit if it lies no further than tolerance outside, absorbing
+// rounding in candidates computed on its boundary. False if it is further;
+// on the fixed-point grid, if it is outside at all.
+bool clampInto(const Rect& fit, Point& p, double tolerance = 1e-7);
+
+// A strip height tall along y and unbounded along x, for Objective::StripLength
+Rect stripRegion(double height);
+
+// Both polygons already rotated and scaled in local coordinates. Exact for
+// convex containers. Otherwise the container is split into convex pieces and
+// their IFPs are returned: every point is a valid fit, but fits straddling
+// two pieces are missed.
+InnerFit computeInnerFit(const Polygon& container, const Polygon& moving);
+
+} // namespace nest
+
+#endif // NEST_INNERFIT_H
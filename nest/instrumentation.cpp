@@ -0,0 +1,283 @@
+#include "instrumentation.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace nest {
+
+const char* counterName(Counter counter)
+{
+    static const char* const names[] = {"nfp_cache_hit", "nfp_cache_miss", "nfp_store_hit", "ifp_cache_hit",
+                                        "ifp_cache_miss", "broad_phase_test", "narrow_phase_test", "hole_attempt",
+                                        "hole_success", "move", "fallback_move", "accepted_move", "fill_candidate"};
+    static_assert(sizeof(names) / sizeof(names[0]) == size_t(Counter::Count), "one name per counter");
+    return names[size_t(counter)];
+}
+
+const char* timerName(Timer timer)
+{
+    static const char* const names[] = {"fill", "anneal", "temperature", "exchange", "nfp",
+                                        "decomposition", "minkowski", "union", "inner_fit"};
+    static_assert(sizeof(names) / sizeof(names[0]) == size_t(Timer::Count), "one name per timer");
+    return names[size_t(timer)];
+}
+
+namespace instrumentation {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t MaxTraceEvents = size_t(1) << 20;
+
+struct TraceEvent
+{
+    Timer timer;
+    int64_t start; // Nanoseconds since the epoch below
+    int64_t duration;
+};
+
+// One thread's counters. Only the owning thread writes them, so relaxed
+// loads and stores are enough; other threads read them for snapshots.
+struct ThreadData
+{
+    int id = 0;
+    std::atomic<uint64_t> counters[size_t(Counter::Count)] = {};
+    std::atomic<uint64_t> timerNanoseconds[size_t(Timer::Count)] = {};
+    std::atomic<uint64_t> timerCalls[size_t(Timer::Count)] = {};
+
+    std::mutex mutex; // Guards the containers below
+    std::map<double, TemperatureStats> temperatures;
+    std::vector<TraceEvent> events;
+};
+
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadData>> threads; // Outlive their threads
+    std::atomic<bool> tracing{false};
+    std::atomic<int64_t> epoch{Clock::now().time_since_epoch().count()};
+};
+
+Registry& registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadData& local()
+{
+    thread_local std::shared_ptr<ThreadData> data = [] {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        auto created = std::make_shared<ThreadData>();
+        created->id = int(r.threads.size()) + 1;
+        r.threads.push_back(created);
+        return created;
+    }();
+    return *data;
+}
+
+void add(std::atomic<uint64_t>& value, uint64_t n)
+{
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+int64_t nanoseconds(Clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+} // namespace
+
+bool enabled()
+{
+#ifdef NEST_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+void count(Counter counter, uint64_t n)
+{
+    add(local().counters[size_t(counter)], n);
+}
+
+void addTime(Timer timer, Clock::time_point start, Clock::time_point end)
+{
+    ThreadData& data = local();
+    const int64_t duration = nanoseconds(end) - nanoseconds(start);
+    add(data.timerNanoseconds[size_t(timer)], uint64_t(duration));
+    add(data.timerCalls[size_t(timer)], 1);
+    Registry& r = registry();
+    if (r.tracing.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(data.mutex);
+        if (data.events.size() < MaxTraceEvents) {
+            data.events.push_back({timer, nanoseconds(start) - r.epoch.load(std::memory_order_relaxed), duration});
+        }
+    }
+}
+
+void setTracing(bool enabled)
+{
+    registry().tracing = enabled;
+}
+
+void reset()
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& data : r.threads) {
+        for (auto& value : data->counters) value = 0;
+        for (auto& value : data->timerNanoseconds) value = 0;
+        for (auto& value : data->timerCalls) value = 0;
+        std::lock_guard<std::mutex> threadLock(data->mutex);
+        data->temperatures.clear();
+        data->events.clear();
+    }
+    r.epoch = nanoseconds(Clock::now());
+}
+
+Snapshot snapshot()
+{
+    Snapshot result;
+    std::map<double, TemperatureStats> temperatures;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& data : r.threads) {
+        for (size_t i = 0; i < size_t(Counter::Count); ++i) result.counters[i] += data->counters[i].load();
+        for (size_t i = 0; i < size_t(Timer::Count); ++i) {
+            result.timerNanoseconds[i] += data->timerNanoseconds[i].load();
+            result.timerCalls[i] += data->timerCalls[i].load();
+        }
+        std::lock_guard<std::mutex> threadLock(data->mutex);
+        for (const auto& entry : data->temperatures) {
+            TemperatureStats& total = temperatures[entry.first];
+            total.temperature = entry.first;
+            total.moves += entry.second.moves;
+            total.accepted += entry.second.accepted;
+        }
+    }
+    for (auto it = temperatures.rbegin(); it != temperatures.rend(); ++it) result.temperatures.push_back(it->second);
+    return result;
+}
+
+static double ratio(uint64_t part, uint64_t whole)
+{
+    return whole ? double(part) / double(whole) : 0.0;
+}
+
+std::string toJson(const Snapshot& s)
+{
+    std::string out = "{\n  \"enabled\": ";
+    out += enabled() ? "true" : "false";
+    char buffer[160];
+
+    out += ",\n  \"counters\": {";
+    for (size_t i = 0; i < size_t(Counter::Count); ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s\n    \"%s\": %llu", i ? "," : "", counterName(Counter(i)),
+                      static_cast<unsigned long long>(s.counters[i]));
+        out += buffer;
+    }
+    out += "\n  },\n  \"timers\": {";
+    for (size_t i = 0; i < size_t(Timer::Count); ++i) {
+        std::snprintf(buffer, sizeof(buffer), "%s\n    \"%s\": {\"seconds\": %.6f, \"calls\": %llu}", i ? "," : "",
+                      timerName(Timer(i)), s.timerNanoseconds[i] * 1e-9, static_cast<unsigned long long>(s.timerCalls[i]));
+        out += buffer;
+    }
+
+    // Moves are counted on every chain, the anneal timer only on the caller's thread
+    const uint64_t nfpLookups = s.counter(Counter::NfpCacheHit) + s.counter(Counter::NfpCacheMiss);
+    const double annealSeconds = s.seconds(Timer::Anneal);
+    std::snprintf(buffer, sizeof(buffer),
+                  "\n  },\n  \"derived\": {\n    \"nfp_hit_ratio\": %.6f,\n    \"hole_success_rate\": %.6f,",
+                  ratio(s.counter(Counter::NfpCacheHit), nfpLookups),
+                  ratio(s.counter(Counter::HoleSuccess), s.counter(Counter::HoleAttempt)));
+    out += buffer;
+    std::snprintf(buffer, sizeof(buffer),
+                  "\n    \"fallback_rate\": %.6f,\n    \"acceptance_ratio\": %.6f,\n    \"moves_per_second\": %.1f\n  },",
+                  ratio(s.counter(Counter::FallbackMove), s.counter(Counter::Move)),
+                  ratio(s.counter(Counter::AcceptedMove), s.counter(Counter::Move)),
+                  annealSeconds > 0 ? s.counter(Counter::Move) / annealSeconds : 0.0);
+    out += buffer;
+
+    out += "\n  \"temperatures\": [";
+    for (size_t i = 0; i < s.temperatures.size(); ++i) {
+        const TemperatureStats& t = s.temperatures[i];
+        std::snprintf(buffer, sizeof(buffer), "%s\n    {\"temperature\": %.6g, \"moves\": %llu, \"accepted\": %llu, \"ratio\": %.4f}",
+                      i ? "," : "", t.temperature, static_cast<unsigned long long>(t.moves),
+                      static_cast<unsigned long long>(t.accepted), ratio(t.accepted, t.moves));
+        out += buffer;
+    }
+    out += s.temperatures.empty() ? "]\n}\n" : "\n  ]\n}\n";
+    return out;
+}
+
+std::string toChromeTrace()
+{
+    std::string out = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    char buffer[160];
+    bool first = true;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (const auto& data : r.threads) {
+        std::lock_guard<std::mutex> threadLock(data->mutex);
+        if (data->events.empty()) continue;
+        std::snprintf(buffer, sizeof(buffer),
+                      "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"nest %d\"}}",
+                      first ? "" : ",", data->id, data->id);
+        out += buffer;
+        first = false;
+        for (const TraceEvent& e : data->events) {
+            std::snprintf(buffer, sizeof(buffer),
+                          ",\n{\"name\": \"%s\", \"cat\": \"nest\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, \"ts\": %.3f, \"dur\": %.3f}",
+                          timerName(e.timer), data->id, e.start * 1e-3, e.duration * 1e-3);
+            out += buffer;
+        }
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+static bool writeFile(const std::string& path, const std::string& contents)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file << contents;
+    return bool(file);
+}
+
+bool writeJson(const std::string& path)
+{
+    return writeFile(path, toJson(snapshot()));
+}
+
+bool writeChromeTrace(const std::string& path)
+{
+    return writeFile(path, toChromeTrace());
+}
+
+TemperatureScope::TemperatureScope(double temperature)
+    : temperature(temperature),
+      moves(local().counters[size_t(Counter::Move)].load(std::memory_order_relaxed)),
+      accepted(local().counters[size_t(Counter::AcceptedMove)].load(std::memory_order_relaxed)),
+      timer(Timer::Temperature)
+{
+}
+
+TemperatureScope::~TemperatureScope()
+{
+    ThreadData& data = local();
+    std::lock_guard<std::mutex> lock(data.mutex);
+    TemperatureStats& stats = data.temperatures[temperature];
+    stats.temperature = temperature;
+    stats.moves += data.counters[size_t(Counter::Move)].load(std::memory_order_relaxed) - moves;
+    stats.accepted += data.counters[size_t(Counter::AcceptedMove)].load(std::memory_order_relaxed) - accepted;
+}
+
+} // namespace instrumentation
+} // namespace nest
@@ -0,0 +1,142 @@
+#ifndef NEST_INSTRUMENTATION_H
+#define NEST_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counters and timers for the engine's hot paths. The NEST_* macros below
+// compile to nothing unless NEST_INSTRUMENTATION is defined (qmake
+// CONFIG+=nest_instrument), so release builds pay nothing. When compiled in,
+// each thread updates its own counters; snapshots sum them.
+namespace nest {
+
+enum class Counter
+{
+    NfpCacheHit,
+    NfpCacheMiss,
+    NfpStoreHit,     // Misses served by the on-disk store
+    IfpCacheHit,
+    IfpCacheMiss,
+    BroadPhaseTest,  // Box tests against spatial grid neighbours
+    NarrowPhaseTest, // Pairs whose boxes intersect, tested exactly
+    HoleAttempt,     // Cavity IFPs the annealer tried a move in
+    HoleSuccess,
+    Move,            // Annealer trial moves
+    FallbackMove,    // Moves that fell back to random perturbation
+    AcceptedMove,
+    FillCandidate,   // Candidate positions scored by BottomLeftFill
+    Count
+};
+
+enum class Timer
+{
+    Fill,
+    Anneal,
+    Temperature,     // One annealing chain at one temperature
+    Exchange,
+    Nfp,             // Computing an NFP, excluding cache lookups
+    Decomposition,
+    Minkowski,
+    Union,
+    InnerFit,
+    Count
+};
+
+const char* counterName(Counter counter);
+const char* timerName(Timer timer);
+
+namespace instrumentation {
+
+struct TemperatureStats
+{
+    double temperature = 0.0;
+    uint64_t moves = 0;
+    uint64_t accepted = 0;
+};
+
+struct Snapshot
+{
+    uint64_t counters[size_t(Counter::Count)] = {};
+    uint64_t timerNanoseconds[size_t(Timer::Count)] = {};
+    uint64_t timerCalls[size_t(Timer::Count)] = {};
+    std::vector<TemperatureStats> temperatures; // Hottest first, summed over chains
+
+    uint64_t counter(Counter c) const { return counters[size_t(c)]; }
+    double seconds(Timer t) const { return timerNanoseconds[size_t(t)] * 1e-9; }
+};
+
+// True when the macros are compiled in
+bool enabled();
+
+void count(Counter counter, uint64_t n);
+void addTime(Timer timer, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+// Trace events are only kept while tracing is on, at most about a million per thread
+void setTracing(bool enabled);
+
+// Zero everything and drop trace events. Call while no optimizer is running.
+void reset();
+Snapshot snapshot();
+
+// Counters, timers, derived rates (NFP hit ratio, fallback rate, hole success
+// rate, moves/s) and acceptance per temperature as one JSON object
+std::string toJson(const Snapshot& snapshot);
+// Timed scopes as Chrome trace events, for chrome://tracing or Perfetto
+std::string toChromeTrace();
+bool writeJson(const std::string& path);
+bool writeChromeTrace(const std::string& path);
+
+// Adds the scope's duration to a timer, and a trace event while tracing
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Timer timer) : timer(timer), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() { addTime(timer, start, std::chrono::steady_clock::now()); }
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Timer timer;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Times one annealing temperature step and books the moves and acceptances
+// this thread counted during it against that temperature
+class TemperatureScope
+{
+public:
+    explicit TemperatureScope(double temperature);
+    ~TemperatureScope();
+    TemperatureScope(const TemperatureScope&) = delete;
+    TemperatureScope& operator=(const TemperatureScope&) = delete;
+
+private:
+    double temperature;
+    uint64_t moves;
+    uint64_t accepted;
+    ScopedTimer timer;
+};
+
+} // namespace instrumentation
+} // namespace nest
+
+#define NEST_CONCAT_(a, b) a##b
+#define NEST_CONCAT(a, b) NEST_CONCAT_(a, b)
+
+#ifdef NEST_INSTRUMENTATION
+#define NEST_COUNT(counter) ::nest::instrumentation::count(::nest::Counter::counter, 1)
+#define NEST_COUNT_N(counter, n) ::nest::instrumentation::count(::nest::Counter::counter, (n))
+#define NEST_TIME_SCOPE(timer) \
+    ::nest::instrumentation::ScopedTimer NEST_CONCAT(nestTimer, __LINE__)(::nest::Timer::timer)
+#define NEST_TEMPERATURE_SCOPE(temperature) \
+    ::nest::instrumentation::TemperatureScope NEST_CONCAT(nestTemperature, __LINE__)(temperature)
+#else
+#define NEST_COUNT(counter) ((void)0)
+#define NEST_COUNT_N(counter, n) ((void)0)
+#define NEST_TIME_SCOPE(timer) ((void)0)
+#define NEST_TEMPERATURE_SCOPE(temperature) ((void)0)
+#endif
+
+#endif // NEST_INSTRUMENTATION_H
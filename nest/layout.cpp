@@ -0,0 +1,89 @@
+#include "layout.h"
+#include "collision.h"
+#include <algorithm>
+
+namespace nest {
+
+Layout::Layout(const PartTable& table, const std::vector<Placement>& placements)
+    : table(&table), current(placements), slots(placements.size()), outlines(placements.size()), boxes(placements.size())
+{
+    double extent = 0.0;
+    for (size_t i = 0; i < placements.size(); ++i) {
+        slots[i] = table.slot(placements[i].rotation);
+        table.place(i, slots[i], placements[i].position, outlines[i]);
+        boxes[i] = table.bounds(i, slots[i]).translated(placements[i].position);
+        extent += std::max(boxes[i].width(), boxes[i].height());
+    }
+
+    // Cells about one part across keep both the cells per box and the ids per cell small
+    if (!placements.empty() && extent > 0) grid = SpatialGrid(extent / placements.size());
+    for (size_t i = 0; i < boxes.size(); ++i) grid.insert(int(i), boxes[i]);
+}
+
+// Whether outline, with bounds box, lies in one of part's holes at slot and position
+static bool inHole(const PartTable& table, size_t part, size_t slot, const Point& position, const Polygon& outline,
+                   const Rect& box)
+{
+    const double slack = 1e-7; // polygonWithin's tolerance for touching boundaries
+    thread_local Polygon hole;
+    for (size_t h = 0; h < table.holeCount(part); ++h) {
+        const Rect holeBox = table.holeBounds(part, slot, h).translated(position);
+        if (box.minX < holeBox.minX - slack || box.maxX > holeBox.maxX + slack || box.minY < holeBox.minY - slack ||
+            box.maxY > holeBox.maxY + slack) {
+            continue;
+        }
+        table.placeHole(part, slot, h, position, hole);
+        if (polygonWithin(outline, hole)) return true;
+    }
+    return false;
+}
+
+bool Layout::overlaps(size_t index, size_t slot, const Polygon& outline, const Rect& box) const
+{
+    const CollisionShape shape{outline, box, table->isConvex(index, slot)};
+    bool hit = false;
+    grid.query(box, [&](int other) {
+        if (hit || size_t(other) == index) return;
+        hit = polygonsOverlap(shape, CollisionShape{outlines[other], boxes[other], table->isConvex(other, slots[other])});
+        // Outlines overlap, but one part may sit in the other's hole. The
+        // table's outline at the origin gives the trial position exactly.
+        if (hit && table->holeCount(other) > 0) {
+            hit = !inHole(*table, size_t(other), slots[other], current[other].position, outline, box);
+        }
+        if (hit && table->holeCount(index) > 0) {
+            const Point position = outline[0] - table->vertices(index, slot)[0];
+            hit = !inHole(*table, index, slot, position, outlines[other], boxes[other]);
+        }
+    });
+    return hit;
+}
+
+void Layout::move(size_t index, const Placement& placement, Polygon& outline)
+{
+    outlines[index].swap(outline);
+    moved(index, placement, table->slot(placement.rotation));
+}
+
+void Layout::unplace(size_t index)
+{
+    outlines[index].clear();
+    boxes[index] = Rect();
+    grid.remove(int(index));
+}
+
+void Layout::move(size_t index, const Placement& placement)
+{
+    const size_t slot = table->slot(placement.rotation);
+    table->place(index, slot, placement.position, outlines[index]);
+    moved(index, placement, slot);
+}
+
+void Layout::moved(size_t index, const Placement& placement, size_t slot)
+{
+    current[index] = placement;
+    slots[index] = slot;
+    boxes[index] = table->bounds(index, slot).translated(placement.position);
+    grid.update(int(index), boxes[index]);
+}
+
+} // namespace nest
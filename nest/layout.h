@@ -0,0 +1,68 @@
+#ifndef NEST_LAYOUT_H
+#define NEST_LAYOUT_H
+
+#include "parttable.h"
+#include "spatialgrid.h"
+#include <vector>
+
+namespace nest {
+
+// Placement state of one nest: where each part is, its placed outline and
+// bounding box, and a spatial grid over those boxes. Outlines come from the
+// PartTable once per accepted move rather than once per overlap test, and
+// overlap queries only run the exact test against parts whose boxes meet.
+// Every placement rotation must have a slot in the table.
+class Layout
+{
+public:
+    Layout() = default;
+    Layout(const PartTable& table, const std::vector<Placement>& placements);
+
+    size_t size() const { return current.size(); }
+    const std::vector<Placement>& placements() const { return current; }
+    const Placement& placement(size_t index) const { return current[index]; }
+    size_t slot(size_t index) const { return slots[index]; }
+    const Polygon& outline(size_t index) const { return outlines[index]; }
+    const Rect& bounds(size_t index) const { return boxes[index]; }
+
+    // True if part index, with the given outline placed in rotation slot,
+    // would overlap any other part. A part lying in another's hole does not
+    // overlap it. The slot is the outline's, not the part's current one: on
+    // the grid, convexity can differ between rotations. outline must be the
+    // table's at that slot. The layout itself is not changed.
+    bool overlaps(size_t index, size_t slot, const Polygon& outline, const Rect& box) const;
+    bool overlaps(size_t index) const { return overlaps(index, slots[index], outlines[index], boxes[index]); }
+
+    // outline must be the table's outline at placement. It is swapped in,
+    // leaving the caller the part's previous outline buffer to place the
+    // next trial into, so steady moves do not allocate. Moving an unplaced
+    // part places it.
+    void move(size_t index, const Placement& placement, Polygon& outline);
+    void move(size_t index, const Placement& placement);
+
+    // Calls fn(index) for every placed part whose box meets box
+    template <typename Fn>
+    void query(const Rect& box, Fn&& fn) const
+    {
+        grid.query(box, fn);
+    }
+
+    // Take a part out of overlap queries until its next move, for layouts
+    // built up one part at a time
+    void unplace(size_t index);
+    bool isPlaced(size_t index) const { return !boxes[index].isEmpty(); }
+
+private:
+    void moved(size_t index, const Placement& placement, size_t slot);
+
+    const PartTable* table = nullptr;
+    std::vector<Placement> current;
+    std::vector<size_t> slots;
+    std::vector<Polygon> outlines;
+    std::vector<Rect> boxes;
+    SpatialGrid grid;
+};
+
+} // namespace nest
+
+#endif // NEST_LAYOUT_H
@@ -0,0 +1,74 @@
+#include "minkowski.h"
+#include "fixedpoint.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+// Rotate the vertex order so the lowest vertex comes first
+static void rotateToLowest(Polygon& poly)
+{
+    auto lowest = std::min_element(poly.begin(), poly.end(), [](const Point& a, const Point& b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    });
+    std::rotate(poly.begin(), lowest, poly.end());
+}
+
+Polygon normalizedConvex(const Polygon& poly)
+{
+    Polygon out = poly;
+    if (signedArea(out) < 0) std::reverse(out.begin(), out.end());
+    removeCollinear(out);
+    if (!out.empty()) rotateToLowest(out);
+    return out;
+}
+
+Polygon minkowskiSumConvex(const Polygon& a, const Polygon& b)
+{
+    const Polygon P = normalizedConvex(a);
+    const Polygon Q = normalizedConvex(b);
+    if (P.empty()) return Q;
+    if (Q.empty()) return P;
+
+    const size_t n = P.size();
+    const size_t m = Q.size();
+    Polygon result;
+    result.reserve(n + m);
+
+    // Both start at their lowest vertex, so edges come in increasing angle
+    size_t i = 0;
+    size_t j = 0;
+    while (i < n || j < m) {
+        result.push_back(P[i % n] + Q[j % m]);
+        const Point edgeP = P[(i + 1) % n] - P[i % n];
+        const Point edgeQ = Q[(j + 1) % m] - Q[j % m];
+        const int turn = orientation(Point(), edgeP, edgeQ);
+        if (j == m || (i < n && turn > 0)) {
+            ++i;
+        } else if (i == n || turn < 0) {
+            ++j;
+        } else {
+            ++i; // Parallel edges merge into one
+            ++j;
+        }
+    }
+
+    removeCollinear(result);
+    rotateToLowest(result);
+    return result;
+}
+
+Polygon minkowskiSumHull(const Polygon& a, const Polygon& b)
+{
+    Polygon result;
+    result.reserve(a.size() * b.size());
+    // Compute pairwise sums of vertices
+    for (const Point& p : a) {
+        for (const Point& q : b) {
+            result.push_back(p + q);
+        }
+    }
+    return convexHull(std::move(result));
+}
+
+} // namespace nest
@@ -0,0 +1,23 @@
+#ifndef NEST_MINKOWSKI_H
+#define NEST_MINKOWSKI_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// Convex polygon in canonical form: counter-clockwise (positive signedArea),
+// no repeated or collinear vertices, starting at the lowest vertex (minimum
+// y, then minimum x). Input must already be convex, in either winding.
+Polygon normalizedConvex(const Polygon& poly);
+
+// Minkowski sum of two convex polygons by merging their edges in angle
+// order, O(n + m). The result is in canonical form.
+Polygon minkowskiSumConvex(const Polygon& a, const Polygon& b);
+
+// Reference implementation: hull of all n*m vertex sums, O(nm log nm).
+// Valid for any input; equals the convex hull of the true Minkowski sum.
+Polygon minkowskiSumHull(const Polygon& a, const Polygon& b);
+
+} // namespace nest
+
+#endif // NEST_MINKOWSKI_H
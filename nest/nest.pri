@@ -0,0 +1,74 @@
+# Headless nesting engine. Depends only on the C++ standard library so it can
+# be linked into the GUI, batch tools and benchmarks alike.
+INCLUDEPATH += $$PWD
+
+# qmake CONFIG+=nest_instrument compiles in the hot-path counters and timers
+nest_instrument: DEFINES += NEST_INSTRUMENTATION
+
+SOURCES += \
+    $$PWD/annealer.cpp \
+    $$PWD/bottomleftfill.cpp \
+    $$PWD/cavity.cpp \
+    $$PWD/collision.cpp \
+    $$PWD/costmodel.cpp \
+    $$PWD/decomposition.cpp \
+    $$PWD/dxfimport.cpp \
+    $$PWD/fixedpoint.cpp \
+    $$PWD/flatten.cpp \
+    $$PWD/geometry.cpp \
+    $$PWD/geometryhash.cpp \
+    $$PWD/importsupport.cpp \
+    $$PWD/innerfit.cpp \
+    $$PWD/instrumentation.cpp \
+    $$PWD/layout.cpp \
+    $$PWD/minkowski.cpp \
+    $$PWD/nfp.cpp \
+    $$PWD/nfpcache.cpp \
+    $$PWD/nfpcalculator.cpp \
+    $$PWD/nfpkey.cpp \
+    $$PWD/nfpstore.cpp \
+    $$PWD/nfpwarmup.cpp \
+    $$PWD/partimport.cpp \
+    $$PWD/partlibrary.cpp \
+    $$PWD/parttable.cpp \
+    $$PWD/polygonunion.cpp \
+    $$PWD/shapes.cpp \
+    $$PWD/sheetpacker.cpp \
+    $$PWD/simplify.cpp \
+    $$PWD/spatialgrid.cpp \
+    $$PWD/svgimport.cpp \
+    $$PWD/threadpool.cpp
+
+HEADERS += \
+    $$PWD/annealer.h \
+    $$PWD/bottomleftfill.h \
+    $$PWD/cavity.h \
+    $$PWD/collision.h \
+    $$PWD/costmodel.h \
+    $$PWD/decomposition.h \
+    $$PWD/fixedpoint.h \
+    $$PWD/flatten.h \
+    $$PWD/geometry.h \
+    $$PWD/geometryhash.h \
+    $$PWD/importsupport.h \
+    $$PWD/innerfit.h \
+    $$PWD/instrumentation.h \
+    $$PWD/layout.h \
+    $$PWD/minkowski.h \
+    $$PWD/nfp.h \
+    $$PWD/nfpcache.h \
+    $$PWD/nfpcalculator.h \
+    $$PWD/nfpkey.h \
+    $$PWD/nfpstore.h \
+    $$PWD/nfpwarmup.h \
+    $$PWD/openhashmap.h \
+    $$PWD/part.h \
+    $$PWD/partimport.h \
+    $$PWD/partlibrary.h \
+    $$PWD/parttable.h \
+    $$PWD/polygonunion.h \
+    $$PWD/shapes.h \
+    $$PWD/sheetpacker.h \
+    $$PWD/simplify.h \
+    $$PWD/spatialgrid.h \
+    $$PWD/threadpool.h
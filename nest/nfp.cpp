@@ -0,0 +1,107 @@
+#include "nfp.h"
+#include "decomposition.h"
+#include "fixedpoint.h"
+#include "instrumentation.h"
+#include "minkowski.h"
+#include "polygonunion.h"
+#include <algorithm>
+
+namespace nest {
+
+bool Nfp::contains(const Point& p) const
+{
+    // On the grid the boundaries, touching positions, are decided exactly: on
+    // the outer loop or on a hole's is clear of the fixed part
+    if (gridEnabled()) {
+        if (locateOnGrid(outer, p) != Location::Inside) return false;
+        for (const Polygon& hole : holes) {
+            if (locateOnGrid(hole, p) != Location::Outside) return false;
+        }
+        return true;
+    }
+    if (!containsPoint(outer, p)) return false;
+    for (const Polygon& hole : holes) {
+        if (containsPoint(hole, p)) return false;
+    }
+    return true;
+}
+
+static const Polygon& negated(const Polygon& poly, Polygon& out)
+{
+    out.resize(poly.size());
+    for (size_t i = 0; i < poly.size(); ++i) out[i] = -poly[i];
+    return out;
+}
+
+Nfp computeNfp(const Polygon& fixedShape, const Polygon& movingShape)
+{
+    Nfp nfp;
+    std::vector<Polygon> fixedPieces, movingPieces;
+    {
+        NEST_TIME_SCOPE(Decomposition);
+        fixedPieces = convexDecomposition(fixedShape);
+        movingPieces = convexDecomposition(movingShape);
+    }
+    if (fixedPieces.empty() || movingPieces.empty()) return nfp;
+
+    Polygon reflected; // One buffer for every reflected piece
+    if (fixedPieces.size() == 1 && movingPieces.size() == 1) {
+        NEST_TIME_SCOPE(Minkowski);
+        nfp.outer = minkowskiSumConvex(fixedPieces[0], negated(movingPieces[0], reflected));
+        return nfp;
+    }
+
+    // Point reflection keeps each convex piece counter-clockwise
+    std::vector<Polygon> sums;
+    sums.reserve(fixedPieces.size() * movingPieces.size());
+    {
+        NEST_TIME_SCOPE(Minkowski);
+        for (const Polygon& a : fixedPieces) {
+            for (const Polygon& b : movingPieces) {
+                sums.push_back(minkowskiSumConvex(a, negated(b, reflected)));
+            }
+        }
+    }
+    std::vector<Polygon> loops;
+    {
+        NEST_TIME_SCOPE(Union);
+        loops = unionOfConvex(sums);
+    }
+
+    // The sum of two connected sets is connected, so there is one outer loop
+    double outerArea = 0.0;
+    for (Polygon& loop : loops) {
+        const double area = signedArea(loop);
+        if (area < 0) {
+            nfp.holes.push_back(std::move(loop));
+        } else if (area > outerArea) {
+            outerArea = area;
+            nfp.outer = std::move(loop);
+        }
+    }
+    return nfp;
+}
+
+double nfpCost(const Polygon& fixedShape, const Polygon& movingShape)
+{
+    const double product = double(fixedShape.size()) * double(movingShape.size());
+    return isConvex(fixedShape) && isConvex(movingShape) ? product : product * 16.0;
+}
+
+void snapToGrid(Nfp& nfp)
+{
+    if (!gridEnabled()) return;
+    auto snapLoop = [](Polygon& loop) {
+        snapToGrid(loop);
+        removeCollinear(loop);
+        return loop.size() >= 3;
+    };
+    if (!snapLoop(nfp.outer)) {
+        nfp = Nfp();
+        return;
+    }
+    nfp.holes.erase(std::remove_if(nfp.holes.begin(), nfp.holes.end(), [&](Polygon& hole) { return !snapLoop(hole); }),
+                    nfp.holes.end());
+}
+
+} // namespace nest
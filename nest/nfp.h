@@ -0,0 +1,39 @@
+#ifndef NEST_NFP_H
+#define NEST_NFP_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// No-fit polygon of a moving part around a fixed one, relative to the fixed
+// part's reference point. The moving part overlaps the fixed one exactly when
+// its reference point lies inside outer and outside every hole. Holes are
+// the feasible pockets a concave fixed part leaves for the moving part; all
+// boundaries are touching positions.
+struct Nfp
+{
+    Polygon outer;              // Counter-clockwise
+    std::vector<Polygon> holes; // Clockwise
+
+    bool isEmpty() const { return outer.empty(); }
+    bool contains(const Point& p) const;
+    Rect boundingRect() const { return nest::boundingRect(outer); }
+};
+
+// Exact NFP of two polygons already rotated and scaled in local coordinates.
+// Convex pairs use a single Minkowski merge; otherwise both are split into
+// convex pieces and the pairwise convex NFPs are unioned.
+Nfp computeNfp(const Polygon& fixedShape, const Polygon& movingShape);
+
+// Relative cost of computeNfp() for the pair: the vertex product, sixteen
+// times over when either is non-convex and the pair goes through
+// decomposition and union. Rotation and scale leave it unchanged.
+double nfpCost(const Polygon& fixedShape, const Polygon& movingShape);
+
+// Snaps every loop to the fixed-point grid, when enabled (fixedpoint.h).
+// Loops that collapse are dropped.
+void snapToGrid(Nfp& nfp);
+
+} // namespace nest
+
+#endif // NEST_NFP_H
@@ -0,0 +1,209 @@
+#include "nfpcache.h"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace nest {
+
+namespace {
+
+// Chunked storage: chunks never move, so pointers into them stay valid
+template <typename T>
+class Pool
+{
+public:
+    T* allocate(size_t n)
+    {
+        if (n > left) {
+            const size_t size = std::max(n, ChunkItems);
+            chunks.emplace_back(new T[size]);
+            next = chunks.back().get();
+            left = size;
+        }
+        T* out = next;
+        next += n;
+        left -= n;
+        return out;
+    }
+
+private:
+    static const size_t ChunkItems = 16384;
+    std::vector<std::unique_ptr<T[]>> chunks;
+    T* next = nullptr;
+    size_t left = 0;
+};
+
+} // namespace
+
+struct NfpCache::Arena
+{
+    Pool<Point> points;
+    Pool<uint32_t> offsets;
+};
+
+// Besides its vertices and offsets, roughly: the entry itself and its index slots
+static const size_t kEntryOverhead = 96;
+
+Nfp NfpView::toNfp() const
+{
+    Nfp nfp;
+    if (loops == 0) return nfp;
+    nfp.outer.assign(outer().begin(), outer().end());
+    for (size_t h = 0; h < holeCount(); ++h) nfp.holes.emplace_back(hole(h).begin(), hole(h).end());
+    return nfp;
+}
+
+NfpCache::Entry::Entry(const NfpKey& key, const Point* points, const uint32_t* offsets, uint32_t loops, size_t bytes,
+                       double cost, uint64_t lastUse)
+    : key(key), points(points), offsets(offsets), loops(loops), bytes(bytes), cost(cost), lastUse(lastUse)
+{
+}
+
+NfpCache::NfpCache() : arena(std::make_shared<Arena>())
+{
+}
+
+NfpCache::~NfpCache() = default;
+
+bool NfpCache::find(const NfpKey& key, NfpView& out)
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const size_t* found = index.find(key);
+    if (!found) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    const Entry& entry = entries[*found];
+    // Only written when stale, so hot entries stay shared between cores
+    if (entry.lastUse.load(std::memory_order_relaxed) != clock) entry.lastUse.store(clock, std::memory_order_relaxed);
+    hits.fetch_add(1, std::memory_order_relaxed);
+    out = view(entry);
+    return true;
+}
+
+NfpView NfpCache::insert(const NfpKey& key, const Nfp& nfp, double cost)
+{
+    // The loops back to back, as the arena stores them
+    thread_local Polygon points;
+    thread_local std::vector<uint32_t> offsets;
+    points.clear();
+    offsets.assign(1, 0);
+    if (!nfp.isEmpty()) {
+        points.insert(points.end(), nfp.outer.begin(), nfp.outer.end());
+        offsets.push_back(uint32_t(points.size()));
+        for (const Polygon& hole : nfp.holes) {
+            points.insert(points.end(), hole.begin(), hole.end());
+            offsets.push_back(uint32_t(points.size()));
+        }
+    }
+    const uint32_t loops = uint32_t(offsets.size() - 1);
+    const size_t entryBytes = points.size() * sizeof(Point) + offsets.size() * sizeof(uint32_t) + kEntryOverhead;
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (const size_t* found = index.find(key)) return view(entries[*found]);
+    if (budget > 0 && bytes + entryBytes > budget) evict();
+    ++clock;
+    return view(add(*arena, key, points.data(), offsets.data(), loops, cost, clock));
+}
+
+// Copies an entry's loops into the arena and indexes it
+const NfpCache::Entry& NfpCache::add(Arena& into, const NfpKey& key, const Point* points, const uint32_t* offsets,
+                                     uint32_t loops, double cost, uint64_t lastUse)
+{
+    const size_t vertices = offsets[loops];
+    Point* ownPoints = into.points.allocate(vertices);
+    uint32_t* ownOffsets = into.offsets.allocate(loops + 1);
+    std::copy(points, points + vertices, ownPoints);
+    std::copy(offsets, offsets + loops + 1, ownOffsets);
+    const size_t entryBytes = vertices * sizeof(Point) + (loops + 1) * sizeof(uint32_t) + kEntryOverhead;
+    entries.emplace_back(key, ownPoints, ownOffsets, loops, entryBytes, cost, lastUse);
+    index.insert(key, entries.size() - 1);
+    bytes += entryBytes;
+    return entries.back();
+}
+
+// Keeps the most valuable entries within three quarters of the budget,
+// packed into a new arena. Called with the lock held exclusively.
+void NfpCache::evict()
+{
+    struct Ranked
+    {
+        double value;
+        uint64_t hash;
+        size_t entry;
+    };
+    std::vector<Ranked> ranked;
+    ranked.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        const double idle = double(clock - entry.lastUse.load(std::memory_order_relaxed));
+        ranked.push_back({entry.cost / double(entry.bytes) / (1.0 + idle), entry.key.hash(), i});
+    }
+    // Ties by key, so which entries survive does not depend on insert order
+    std::sort(ranked.begin(), ranked.end(), [](const Ranked& a, const Ranked& b) {
+        return a.value != b.value ? a.value > b.value : a.hash < b.hash;
+    });
+
+    std::shared_ptr<Arena> oldArena = std::move(arena);
+    std::deque<Entry> old;
+    old.swap(entries);
+    index.clear();
+    bytes = 0;
+    arena = std::make_shared<Arena>();
+    const size_t target = budget - budget / 4;
+    for (const Ranked& r : ranked) {
+        const Entry& entry = old[r.entry];
+        if (bytes + entry.bytes > target) {
+            ++evictions;
+            continue;
+        }
+        add(*arena, entry.key, entry.points, entry.offsets, entry.loops, entry.cost,
+            entry.lastUse.load(std::memory_order_relaxed));
+    }
+}
+
+NfpView NfpCache::view(const Entry& entry) const
+{
+    NfpView out;
+    out.arena = arena;
+    out.points = entry.points;
+    out.offsets = entry.offsets;
+    out.loops = entry.loops;
+    return out;
+}
+
+void NfpCache::setBudget(size_t bytes)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    budget = bytes;
+}
+
+NfpCacheStats NfpCache::stats() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    NfpCacheStats stats;
+    stats.hits = hits.load(std::memory_order_relaxed);
+    stats.misses = misses.load(std::memory_order_relaxed);
+    stats.evictions = evictions;
+    stats.entries = entries.size();
+    stats.bytes = bytes;
+    stats.budget = budget;
+    return stats;
+}
+
+size_t NfpCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return entries.size();
+}
+
+void NfpCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    bytes = 0;
+    arena = std::make_shared<Arena>();
+}
+
+} // namespace nest
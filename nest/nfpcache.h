@@ -0,0 +1,131 @@
+#ifndef NEST_NFPCACHE_H
+#define NEST_NFPCACHE_H
+
+#include "nfp.h"
+#include "nfpkey.h"
+#include "openhashmap.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <shared_mutex>
+
+namespace nest {
+
+// Vertices of one NFP loop, in place in an NfpCache's arena
+struct LoopView
+{
+    const Point* points = nullptr;
+    size_t count = 0;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Point& operator[](size_t i) const { return points[i]; }
+    const Point& front() const { return points[0]; }
+    const Point* begin() const { return points; }
+    const Point* end() const { return points + count; }
+};
+
+// An NFP held by an NfpCache, laid out as in Nfp. Holding a view keeps its
+// vertices alive even if the cache evicts the entry or is cleared meanwhile.
+class NfpView
+{
+public:
+    NfpView() = default;
+
+    bool isEmpty() const { return loops == 0 || offsets[1] == 0; }
+    LoopView outer() const { return loop(0); }
+    size_t holeCount() const { return loops > 0 ? loops - 1 : 0; }
+    LoopView hole(size_t i) const { return loop(i + 1); }
+    Nfp toNfp() const;
+
+private:
+    friend class NfpCache;
+
+    LoopView loop(size_t i) const
+    {
+        if (i >= loops) return LoopView();
+        return {points + offsets[i], size_t(offsets[i + 1] - offsets[i])};
+    }
+
+    std::shared_ptr<const void> arena; // Keeps points and offsets allocated
+    const Point* points = nullptr;
+    const uint32_t* offsets = nullptr; // loops + 1 vertex offsets into points
+    uint32_t loops = 0;
+};
+
+struct NfpCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;  // Vertices, loop offsets and per-entry bookkeeping
+    size_t budget = 0; // 0 is unbounded
+};
+
+// Thread-safe NFP cache with an optional byte budget. Vertices of all
+// entries are packed back to back in pooled chunks rather than one vector
+// per loop. Once an insert takes the cache over budget, the least valuable
+// entries are evicted until a quarter of the budget is free again and the
+// survivors are packed into a fresh arena; views into the old one keep it
+// alive until they are dropped. An entry's value is the cost of computing
+// it per byte (nfpCost()), divided by one plus the number of inserts since
+// it was last used: expensive non-convex NFPs outlast cheap convex ones, and
+// within a cost class the least recently used go first.
+class NfpCache
+{
+public:
+    NfpCache();
+    ~NfpCache();
+    NfpCache(const NfpCache&) = delete;
+    NfpCache& operator=(const NfpCache&) = delete;
+
+    // Counts a hit or a miss
+    bool find(const NfpKey& key, NfpView& view);
+    // First insert wins: if another thread got there first, its entry is returned.
+    // cost is the relative cost of computing nfp, from nfpCost().
+    NfpView insert(const NfpKey& key, const Nfp& nfp, double cost);
+
+    // Takes effect on the next insert
+    void setBudget(size_t bytes);
+    NfpCacheStats stats() const;
+    size_t size() const;
+    void clear();
+
+private:
+    struct Arena;
+    struct Entry
+    {
+        NfpKey key;
+        const Point* points;
+        const uint32_t* offsets;
+        uint32_t loops;
+        size_t bytes;
+        double cost;
+        mutable std::atomic<uint64_t> lastUse; // Insert clock when last found or inserted
+
+        Entry(const NfpKey& key, const Point* points, const uint32_t* offsets, uint32_t loops, size_t bytes,
+              double cost, uint64_t lastUse);
+    };
+
+    NfpView view(const Entry& entry) const;
+    const Entry& add(Arena& into, const NfpKey& key, const Point* points, const uint32_t* offsets, uint32_t loops,
+                     double cost, uint64_t lastUse);
+    void evict();
+
+    std::shared_ptr<Arena> arena;
+    std::deque<Entry> entries;
+    OpenHashMap<NfpKey, size_t> index; // Into entries
+    size_t budget = 0;
+    size_t bytes = 0;
+    uint64_t clock = 0;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+    uint64_t evictions = 0;
+    mutable std::shared_mutex mutex;
+};
+
+} // namespace nest
+
+#endif // NEST_NFPCACHE_H
@@ -0,0 +1,94 @@
+#include "nfpcalculator.h"
+#include "fixedpoint.h"
+#include "instrumentation.h"
+#include "nfpstore.h"
+
+namespace nest {
+
+// Get or compute NFP for a shape pair at given rotations
+NfpView nfpcalculator::getNFP(const Part& fixedShape, const Part& movingShape,
+                              double fixedRotation, double movingRotation)
+{
+    // Return cached NFP if available
+    const NfpKey key(fixedShape, movingShape, fixedRotation, movingRotation);
+    NfpView cached;
+    if (nfpCache.find(key, cached)) {
+        NEST_COUNT(NfpCacheHit);
+        return cached;
+    }
+    NEST_COUNT(NfpCacheMiss);
+    const double cost = nfpCost(fixedShape.outline, movingShape.outline);
+
+    // Then the on-disk library shared with other processes
+    Nfp stored;
+    if (nfpStore && nfpStore->find(key, stored)) {
+        NEST_COUNT(NfpStoreHit);
+        return nfpCache.insert(key, stored, cost);
+    }
+
+    // Scale and rotate both outlines about their local origins, into
+    // per-thread buffers: only what the cache keeps is allocated for it
+    thread_local Polygon rotatedA, rotatedB;
+    transform(fixedShape.outline, canonicalRotation(fixedShape, fixedRotation), fixedShape.scale, Point(), rotatedA);
+    transform(movingShape.outline, canonicalRotation(movingShape, movingRotation), movingShape.scale, Point(), rotatedB);
+    snapToGrid(rotatedA);
+    snapToGrid(rotatedB);
+
+    // Compute NFP and cache it
+    Nfp computed;
+    {
+        NEST_TIME_SCOPE(Nfp);
+        computed = computeNfp(rotatedA, rotatedB);
+    }
+    snapToGrid(computed);
+    if (nfpStore) {
+        nfpStore->append(key, computed);
+    }
+    return nfpCache.insert(key, computed, cost);
+}
+
+size_t nfpcalculator::cachedCount() const
+{
+    return nfpCache.size();
+}
+
+void nfpcalculator::clearCache()
+{
+    nfpCache.clear();
+    std::unique_lock<std::shared_mutex> lock(cacheMutex);
+    ifpCache.clear();
+}
+
+// Get or compute the IFP of a small shape inside a cavity of another shape
+const InnerFit& nfpcalculator::getIFP(const Part& holeShape, size_t cavity, const Part& smallShape,
+                                      double holeRotation, double smallRotation)
+{
+    const NfpKey key = innerFitKey(holeShape, cavity, smallShape, holeRotation, smallRotation);
+    {
+        std::shared_lock<std::shared_mutex> lock(cacheMutex);
+        if (const InnerFit* cached = ifpCache.find(key)) {
+            NEST_COUNT(IfpCacheHit);
+            return *cached;
+        }
+    }
+    NEST_COUNT(IfpCacheMiss);
+
+    InnerFit ifp;
+    {
+        NEST_TIME_SCOPE(InnerFit);
+        thread_local Polygon region, small;
+        transform(holeShape.cavities[cavity].region, holeRotation, holeShape.scale, Point(), region);
+        transform(smallShape.outline, canonicalRotation(smallShape, smallRotation), smallShape.scale, Point(), small);
+        snapToGrid(region);
+        snapToGrid(small);
+        ifp = computeInnerFit(region, small);
+    }
+    for (Polygon& fit : ifp.regions) snapToGrid(fit);
+    std::unique_lock<std::shared_mutex> lock(cacheMutex);
+    if (const InnerFit* existing = ifpCache.find(key)) {
+        return *existing;
+    }
+    return ifpCache.insert(key, std::move(ifp));
+}
+
+} // namespace nest
@@ -0,0 +1,71 @@
+#ifndef NFPCALCULATOR_H
+#define NFPCALCULATOR_H
+
+#include "innerfit.h"
+#include "nfp.h"
+#include "nfpcache.h"
+#include "nfpkey.h"
+#include "openhashmap.h"
+#include "part.h"
+#include <shared_mutex>
+
+namespace nest {
+
+class NfpStore;
+
+// Computes and caches NFPs. Entries are keyed by geometry, so the calculator
+// can live as long as the application: identical parts share entries and
+// nothing needs to be invalidated when the scene changes. getNFP() may be
+// called from several optimizer threads at once; the views it returns stay
+// valid as long as they are held, whatever the cache evicts meanwhile.
+class nfpcalculator
+{
+public:
+    nfpcalculator() = default;
+
+    // Optional on-disk library consulted on a cache miss before computing;
+    // newly computed NFPs are appended to it. Not owned.
+    void setStore(NfpStore* store) { nfpStore = store; }
+
+    // Exact NFP of moving around fixed, relative to fixed's reference point:
+    // moving placed at fixed.position + nfpOffset() + p overlaps fixed iff
+    // nfp.contains(p). Symmetric parts share one entry between rotations a
+    // period apart, computed at their canonicalRotation(); the offset moves
+    // it to the rotations asked about and is zero for other parts.
+    NfpView getNFP(const Part& fixedShape, const Part& movingShape, double fixedRotation, double movingRotation);
+    size_t cachedCount() const;
+    void clearCache();
+
+    // Bytes the NFP cache may hold before it evicts (see NfpCache); 0, the
+    // default, is unbounded
+    void setCacheBudget(size_t bytes) { nfpCache.setBudget(bytes); }
+    NfpCacheStats cacheStats() const { return nfpCache.stats(); }
+
+    // Hole handling. The IFP holds the reference points, relative to the holed
+    // part's own plus ifpOffset(), at which the small part lies inside one of
+    // its cavities.
+    // Cached and thread-safe like getNFP(), but unbounded: references stay
+    // valid until clearCache(). Empty if nothing fits.
+    const InnerFit& getIFP(const Part& holeShape, size_t cavity, const Part& smallShape, double holeRotation,
+                           double smallRotation);
+
+private:
+    NfpCache nfpCache; // cache nfps by geometry, rotations and scales
+    OpenHashMap<NfpKey, InnerFit> ifpCache;
+    mutable std::shared_mutex cacheMutex; // Guards ifpCache
+    NfpStore* nfpStore = nullptr;
+};
+
+inline Point nfpOffset(const Part& fixedShape, const Part& movingShape, double fixedRotation, double movingRotation)
+{
+    return symmetryShift(fixedShape, fixedRotation) - symmetryShift(movingShape, movingRotation);
+}
+
+inline Point ifpOffset(const Part& smallShape, double smallRotation)
+{
+    return -symmetryShift(smallShape, smallRotation);
+}
+
+} // namespace nest
+
+#endif // NFPCALCULATOR_H
@@ -0,0 +1,50 @@
+#include "nfpkey.h"
+#include "fixedpoint.h"
+
+namespace nest {
+
+int32_t rotationKey(double rotation)
+{
+    int64_t millidegrees = quantize(rotation, 1e-3) % 360000;
+    if (millidegrees < 0) millidegrees += 360000;
+    return int32_t(millidegrees);
+}
+
+NfpKey::NfpKey(const Part& fixedShape, const Part& movingShape, double fixedRotation, double movingRotation)
+    : fixedHash(fixedShape.hash ? fixedShape.hash : geometryHash(fixedShape.outline)),
+      movingHash(movingShape.hash ? movingShape.hash : geometryHash(movingShape.outline)),
+      fixedRotation(rotationKey(canonicalRotation(fixedShape, fixedRotation))),
+      movingRotation(rotationKey(canonicalRotation(movingShape, movingRotation))),
+      fixedScale(quantize(fixedShape.scale)),
+      movingScale(quantize(movingShape.scale))
+{
+    // Snapped outlines make different NFPs, so each grid keeps its own entries
+    if (gridEnabled()) fixedHash = hashCombine(fixedHash, uint64_t(quantize(gridResolution(), 1e-12)));
+}
+
+NfpKey innerFitKey(const Part& holeShape, size_t cavity, const Part& smallShape, double holeRotation,
+                   double smallRotation)
+{
+    // Cavities follow from the outline, so its hash and the index identify one
+    NfpKey key(holeShape, smallShape, holeRotation, smallRotation);
+    key.fixedHash = hashCombine(key.fixedHash, uint64_t(cavity) + 1);
+    key.fixedRotation = rotationKey(holeRotation);
+    return key;
+}
+
+uint64_t NfpKey::hash() const
+{
+    uint64_t h = hashCombine(fixedHash, movingHash);
+    h = hashCombine(h, (uint64_t(uint32_t(fixedRotation)) << 32) | uint32_t(movingRotation));
+    h = hashCombine(h, uint64_t(fixedScale));
+    return hashCombine(h, uint64_t(movingScale));
+}
+
+bool NfpKey::operator==(const NfpKey& other) const
+{
+    return fixedHash == other.fixedHash && movingHash == other.movingHash &&
+           fixedRotation == other.fixedRotation && movingRotation == other.movingRotation &&
+           fixedScale == other.fixedScale && movingScale == other.movingScale;
+}
+
+} // namespace nest
@@ -0,0 +1,39 @@
+#ifndef NEST_NFPKEY_H
+#define NEST_NFPKEY_H
+
+#include "part.h"
+#include <cstdint>
+
+namespace nest {
+
+// Cache key: what the NFP depends on, not which scene item asked for it.
+// Rotations are reduced to the part's canonicalRotation(), normalized to
+// [0, 360) in millidegrees, and scales quantized.
+struct NfpKey
+{
+    uint64_t fixedHash = 0;
+    uint64_t movingHash = 0;
+    int32_t fixedRotation = 0;
+    int32_t movingRotation = 0;
+    int64_t fixedScale = 0;
+    int64_t movingScale = 0;
+
+    NfpKey() = default;
+    NfpKey(const Part& fixedShape, const Part& movingShape, double fixedRotation, double movingRotation);
+
+    uint64_t hash() const;
+    bool operator==(const NfpKey& other) const;
+};
+
+// Key of the IFP of smallShape in a cavity of holeShape. Cavities need not
+// map onto themselves under the holed part's symmetry, so its rotation is
+// kept as given.
+NfpKey innerFitKey(const Part& holeShape, size_t cavity, const Part& smallShape, double holeRotation,
+                   double smallRotation);
+
+// Rotation in degrees normalized to [0, 360) millidegrees
+int32_t rotationKey(double rotation);
+
+} // namespace nest
+
+#endif // NEST_NFPKEY_H
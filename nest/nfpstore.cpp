@@ -0,0 +1,284 @@
+#include "nfpstore.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace nest {
+
+static_assert(sizeof(Point) == 2 * sizeof(double), "vertices are stored as flat x, y pairs");
+
+static const char kFileMagic[8] = {'N', 'F', 'P', 'S', 'T', 'O', 'R', 'E'};
+static const uint32_t kRecordMagic = 0x5250464e; // "NFPR"
+static const size_t kHeaderBytes = 16;
+static const size_t kKeyBytes = 40;
+static const size_t kMinRecordBytes = 8 + kKeyBytes + 8 + 8;
+
+template <typename T>
+static void put(std::vector<char>& buffer, T value)
+{
+    const size_t at = buffer.size();
+    buffer.resize(at + sizeof(T));
+    std::memcpy(buffer.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+static T get(const char* data)
+{
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+static uint64_t checksum(const char* data, size_t bytes)
+{
+    uint64_t hash = hashMix(bytes);
+    for (size_t i = 0; i + 8 <= bytes; i += 8) {
+        hash = hashCombine(hash, get<uint64_t>(data + i));
+    }
+    return hash;
+}
+
+static NfpKey readKey(const char* data)
+{
+    NfpKey key;
+    key.fixedHash = get<uint64_t>(data);
+    key.movingHash = get<uint64_t>(data + 8);
+    key.fixedRotation = get<int32_t>(data + 16);
+    key.movingRotation = get<int32_t>(data + 20);
+    key.fixedScale = get<int64_t>(data + 24);
+    key.movingScale = get<int64_t>(data + 32);
+    return key;
+}
+
+// Size of a well-formed record at data, or 0
+static size_t validRecord(const char* data, size_t available)
+{
+    if (available < kMinRecordBytes || get<uint32_t>(data) != kRecordMagic) return 0;
+    const size_t bytes = get<uint32_t>(data + 4);
+    if (bytes < kMinRecordBytes || bytes > available || bytes % 8 != 0) return 0;
+    if (checksum(data, bytes - 8) != get<uint64_t>(data + bytes - 8)) return 0;
+    return bytes;
+}
+
+NfpStore::~NfpStore()
+{
+    close();
+}
+
+#ifndef _WIN32
+
+bool NfpStore::open(const std::string& path)
+{
+    close();
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+
+    // Create or validate the header under the lock so concurrent first opens agree
+    ::flock(fd, LOCK_EX);
+    struct stat st;
+    bool valid = ::fstat(fd, &st) == 0;
+    if (valid && st.st_size == 0) {
+        std::vector<char> header(kFileMagic, kFileMagic + 8);
+        put<uint32_t>(header, Version);
+        put<uint32_t>(header, uint32_t(kHeaderBytes));
+        valid = ::write(fd, header.data(), header.size()) == ssize_t(header.size());
+    } else if (valid) {
+        char header[kHeaderBytes];
+        valid = ::pread(fd, header, kHeaderBytes, 0) == ssize_t(kHeaderBytes) &&
+                std::memcmp(header, kFileMagic, 8) == 0 && get<uint32_t>(header + 8) == Version &&
+                get<uint32_t>(header + 12) == kHeaderBytes;
+    }
+    ::flock(fd, LOCK_UN);
+    if (!valid) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+
+    filePath = path;
+    indexedBytes = kHeaderBytes;
+    if (mapFile()) indexRecords();
+    return true;
+}
+
+void NfpStore::close()
+{
+    unmapFile();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    index.clear();
+    indexedBytes = 0;
+    ownBytes = 0;
+}
+
+bool NfpStore::mapFile()
+{
+    struct stat st;
+    if (fd < 0 || ::fstat(fd, &st) != 0) return false;
+    const size_t size = size_t(st.st_size);
+    if (size == mappedSize) return mapped != nullptr;
+    unmapFile();
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) return false;
+    mapped = static_cast<const char*>(address);
+    mappedSize = size;
+    return true;
+}
+
+size_t NfpStore::fileSize() const
+{
+    struct stat st;
+    return fd >= 0 && ::fstat(fd, &st) == 0 ? size_t(st.st_size) : 0;
+}
+
+void NfpStore::unmapFile()
+{
+    if (mapped) ::munmap(const_cast<char*>(mapped), mappedSize);
+    mapped = nullptr;
+    mappedSize = 0;
+}
+
+bool NfpStore::append(const NfpKey& key, const Nfp& nfp)
+{
+    if (fd < 0 || nfp.isEmpty()) return false;
+
+    std::vector<char> record;
+    put<uint32_t>(record, kRecordMagic);
+    put<uint32_t>(record, 0); // Patched below
+    put<uint64_t>(record, key.fixedHash);
+    put<uint64_t>(record, key.movingHash);
+    put<int32_t>(record, key.fixedRotation);
+    put<int32_t>(record, key.movingRotation);
+    put<int64_t>(record, key.fixedScale);
+    put<int64_t>(record, key.movingScale);
+    put<uint32_t>(record, uint32_t(1 + nfp.holes.size()));
+    put<uint32_t>(record, 0);
+    put<uint32_t>(record, uint32_t(nfp.outer.size()));
+    put<uint32_t>(record, 0);
+    for (const Polygon& hole : nfp.holes) {
+        put<uint32_t>(record, uint32_t(hole.size()));
+        put<uint32_t>(record, 1);
+    }
+    auto putLoop = [&record](const Polygon& loop) {
+        for (const Point& p : loop) {
+            put<double>(record, p.x);
+            put<double>(record, p.y);
+        }
+    };
+    putLoop(nfp.outer);
+    for (const Polygon& hole : nfp.holes) putLoop(hole);
+    const uint32_t bytes = uint32_t(record.size() + 8);
+    std::memcpy(record.data() + 4, &bytes, 4);
+    put<uint64_t>(record, checksum(record.data(), record.size()));
+
+    std::lock_guard<std::mutex> guard(appendMutex);
+    ::flock(fd, LOCK_EX);
+    size_t written = 0;
+    while (written < record.size()) {
+        const ssize_t n = ::write(fd, record.data() + written, record.size() - written);
+        if (n <= 0) break;
+        written += size_t(n);
+    }
+    ::flock(fd, LOCK_UN);
+    ownBytes.fetch_add(written, std::memory_order_relaxed);
+    return written == record.size();
+}
+
+#else
+
+// No mmap/flock here: the store stays closed and NFPs are computed as usual
+bool NfpStore::open(const std::string&) { return false; }
+void NfpStore::close() {}
+bool NfpStore::mapFile() { return false; }
+size_t NfpStore::fileSize() const { return 0; }
+void NfpStore::unmapFile() {}
+bool NfpStore::append(const NfpKey&, const Nfp&) { return false; }
+
+#endif
+
+void NfpStore::indexRecords()
+{
+    size_t offset = indexedBytes;
+    while (offset + kMinRecordBytes <= mappedSize) {
+        size_t bytes = validRecord(mapped + offset, mappedSize - offset);
+        if (bytes == 0) {
+            // Torn record from a crashed writer: resume at the next valid one,
+            // byte by byte as the torn write may be any length. At the tail it
+            // may still be in flight, so leave it for a later find() miss.
+            size_t next = offset + 1;
+            while (next + kMinRecordBytes <= mappedSize && validRecord(mapped + next, mappedSize - next) == 0) ++next;
+            if (next + kMinRecordBytes > mappedSize) break;
+            offset = next;
+            continue;
+        }
+        const NfpKey key = readKey(mapped + offset + 8);
+        if (!index.find(key)) index.insert(key, offset);
+        offset += bytes;
+    }
+    indexedBytes = offset;
+}
+
+bool NfpStore::find(const NfpKey& key, Nfp& nfp)
+{
+    {
+        std::shared_lock<std::shared_mutex> lock(mapMutex);
+        if (const size_t* offset = index.find(key)) {
+            readRecord(*offset, nfp);
+            return true;
+        }
+        if (!grown()) return false;
+    }
+
+    // Other processes have appended since: map and index their records
+    std::unique_lock<std::shared_mutex> lock(mapMutex);
+    if (grown() && mapFile()) {
+        ownBytes.store(0, std::memory_order_relaxed);
+        indexRecords();
+    }
+    const size_t* offset = index.find(key);
+    if (!offset) return false;
+    readRecord(*offset, nfp);
+    return true;
+}
+
+// By more than this store's own records, which the caller's cache already
+// holds: remapping for those on every miss would cost more than it saves
+bool NfpStore::grown() const
+{
+    return fileSize() > mappedSize + ownBytes.load(std::memory_order_relaxed);
+}
+
+size_t NfpStore::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(mapMutex);
+    return index.size();
+}
+
+void NfpStore::readRecord(size_t offset, Nfp& nfp) const
+{
+    const char* record = mapped + offset;
+    const uint32_t loopCount = get<uint32_t>(record + 8 + kKeyBytes);
+    const char* loopHeader = record + 8 + kKeyBytes + 8;
+    const char* vertices = loopHeader + 8 * size_t(loopCount);
+    nfp = Nfp();
+    for (uint32_t i = 0; i < loopCount; ++i) {
+        const uint32_t count = get<uint32_t>(loopHeader + 8 * i);
+        const bool hole = get<uint32_t>(loopHeader + 8 * i + 4) & 1;
+        Polygon loop(count);
+        std::memcpy(loop.data(), vertices, count * sizeof(Point));
+        vertices += count * sizeof(Point);
+        if (hole) {
+            nfp.holes.push_back(std::move(loop));
+        } else {
+            nfp.outer = std::move(loop);
+        }
+    }
+}
+
+} // namespace nest
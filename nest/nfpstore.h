@@ -0,0 +1,74 @@
+#ifndef NEST_NFPSTORE_H
+#define NEST_NFPSTORE_H
+
+#include "nfp.h"
+#include "nfpkey.h"
+#include "openhashmap.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace nest {
+
+// Persistent NFP library: an append-only file of NFP records keyed by NfpKey,
+// mapped read-only when opened so a known part catalog starts warm.
+//
+// Layout (native little-endian, every field 8-byte aligned within its record):
+//   header:  "NFPSTORE" | uint32 version | uint32 header bytes
+//   record:  uint32 'NFPR' | uint32 record bytes | NfpKey (40 bytes)
+//            | uint32 loop count | uint32 0
+//            | per loop: uint32 vertex count | uint32 flags (1 = hole)
+//            | vertices as x, y doubles, loop after loop
+//            | uint64 checksum of everything before it
+//
+// Appends take an exclusive flock and write each record with a single
+// O_APPEND write, so several nesting processes on one host can share a file.
+// Readers skip incomplete or corrupt records, so a crash mid write only loses
+// that record. A miss in find() maps whatever other processes appended since,
+// so a GUI and nestbatch sharing a store see each other's NFPs. find() and
+// append() are thread-safe; open() and close() must not run concurrently
+// with them.
+class NfpStore
+{
+public:
+    static const uint32_t Version = 1;
+
+    NfpStore() = default;
+    ~NfpStore();
+    NfpStore(const NfpStore&) = delete;
+    NfpStore& operator=(const NfpStore&) = delete;
+
+    // Open or create the store. Returns false if the file cannot be created or
+    // belongs to a different format version; the store then stays closed.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return fd >= 0; }
+
+    bool find(const NfpKey& key, Nfp& nfp);
+    bool append(const NfpKey& key, const Nfp& nfp);
+
+    size_t size() const;
+
+private:
+    bool mapFile();
+    void unmapFile();
+    void indexRecords();
+    size_t fileSize() const;
+    bool grown() const;
+    void readRecord(size_t offset, Nfp& nfp) const;
+
+    std::string filePath;
+    int fd = -1;
+    const char* mapped = nullptr;
+    size_t mappedSize = 0;
+    size_t indexedBytes = 0;
+    OpenHashMap<NfpKey, size_t> index; // Record offsets into mapped
+    mutable std::shared_mutex mapMutex; // Guards mapped and index: remapping moves the records
+    std::mutex appendMutex;             // flock does not exclude threads sharing fd
+    std::atomic<size_t> ownBytes{0};    // Appended by this store since the last mapping
+};
+
+} // namespace nest
+
+#endif // NEST_NFPSTORE_H
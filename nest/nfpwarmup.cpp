@@ -0,0 +1,106 @@
+#include "nfpwarmup.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace nest {
+
+namespace {
+
+struct Request
+{
+    const Part* fixed;
+    const Part* moving;
+    double fixedRotation;
+    double movingRotation;
+    size_t cavity;    // NoCavity for an NFP
+    double cost;      // Rough relative cost, to start the slowest first
+};
+
+const size_t NoCavity = size_t(-1);
+
+} // namespace
+
+NfpWarmUp::NfpWarmUp(const std::vector<Part>& parts, nfpcalculator& nfpCalc, std::vector<double> rotations, int threads)
+    : parts(parts), nfpCalc(nfpCalc), rotations(std::move(rotations)), threads(threads)
+{
+}
+
+size_t NfpWarmUp::run()
+{
+    // One representative per distinct geometry and scale
+    std::vector<const Part*> kinds;
+    OpenHashMap<NfpKey, char> seenKinds;
+    for (const Part& part : parts) {
+        const NfpKey key(part, part, 0.0, 0.0);
+        if (seenKinds.find(key)) continue;
+        seenKinds.insert(key, 0);
+        kinds.push_back(&part);
+    }
+
+    std::vector<Request> requests;
+    OpenHashMap<NfpKey, char> seen;
+    auto add = [&](size_t f, size_t m, double fixedRotation, double movingRotation, size_t cavity, double cost) {
+        const NfpKey key = cavity == NoCavity ? NfpKey(*kinds[f], *kinds[m], fixedRotation, movingRotation)
+                                              : innerFitKey(*kinds[f], cavity, *kinds[m], fixedRotation, movingRotation);
+        if (seen.find(key)) return;
+        seen.insert(key, 0);
+        requests.push_back({kinds[f], kinds[m], fixedRotation, movingRotation, cavity, cost});
+    };
+    for (size_t f = 0; f < kinds.size(); ++f) {
+        const Part& fixed = *kinds[f];
+        for (size_t m = 0; m < kinds.size(); ++m) {
+            const Part& moving = *kinds[m];
+            const double cost = nfpCost(fixed.outline, moving.outline);
+            for (double fixedRotation : rotations) {
+                for (double movingRotation : rotations) add(f, m, fixedRotation, movingRotation, NoCavity, cost);
+            }
+
+            // The annealer's and the fill's cavity tests: area, then rotated boxes
+            const double scale = moving.scale / fixed.scale;
+            const double area = std::abs(signedArea(moving.outline)) * scale * scale;
+            const size_t cavities = cavitiesAtLeast(fixed.cavities, area);
+            for (size_t c = 0; c < cavities; ++c) {
+                const Polygon& region = fixed.cavities[c].region;
+                for (double fixedRotation : rotations) {
+                    const Rect hole = boundingRect(transformed(region, fixedRotation, fixed.scale));
+                    for (double movingRotation : rotations) {
+                        const Rect small = boundingRect(transformed(moving.outline, movingRotation, moving.scale));
+                        if (small.width() > hole.width() || small.height() > hole.height()) continue;
+                        add(f, m, fixedRotation, movingRotation, c, double(region.size()) * moving.outline.size());
+                    }
+                }
+            }
+        }
+    }
+
+    // Slowest first, dealt out round robin so that every thread's starting
+    // block of the pool gets a share of them; stealing evens out the rest
+    std::stable_sort(requests.begin(), requests.end(), [](const Request& a, const Request& b) { return a.cost > b.cost; });
+    ThreadPool pool(threads);
+    const size_t lanes = size_t(pool.threadCount());
+    std::vector<Request> dealt;
+    dealt.reserve(requests.size());
+    for (size_t lane = 0; lane < lanes; ++lane) {
+        for (size_t i = lane; i < requests.size(); i += lanes) dealt.push_back(requests[i]);
+    }
+
+    std::atomic<size_t> finished{0};
+    const std::thread::id caller = std::this_thread::get_id();
+    pool.parallelFor(dealt.size(), [&](size_t i) {
+        if (stopFlag && stopFlag->load(std::memory_order_relaxed)) return;
+        const Request& r = dealt[i];
+        if (r.cavity == NoCavity) {
+            nfpCalc.getNFP(*r.fixed, *r.moving, r.fixedRotation, r.movingRotation);
+        } else {
+            nfpCalc.getIFP(*r.fixed, r.cavity, *r.moving, r.fixedRotation, r.movingRotation);
+        }
+        const size_t done = ++finished;
+        if (progress && std::this_thread::get_id() == caller) progress(done, dealt.size());
+    });
+    if (progress) progress(finished, dealt.size());
+    return finished;
+}
+
+} // namespace nest
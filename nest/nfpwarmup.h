@@ -0,0 +1,44 @@
+#ifndef NEST_NFPWARMUP_H
+#define NEST_NFPWARMUP_H
+
+#include "nfpcalculator.h"
+#include <atomic>
+#include <functional>
+#include <vector>
+
+namespace nest {
+
+// Optional stage before optimizing. The placers compute NFPs lazily, one at
+// a time on first use, so their early moves wait on cold Minkowski sums.
+// This enumerates every NFP between the parts at every pair of the given
+// rotations, and every IFP of a part in a cavity it can fit, and computes
+// them on all cores into the calculator's cache, where getNFP() and getIFP()
+// then find them. Requests with equal cache keys are computed once.
+class NfpWarmUp
+{
+public:
+    NfpWarmUp(const std::vector<Part>& parts, nfpcalculator& nfpCalc, std::vector<double> rotations, int threads = 0);
+
+    // Returns the number of distinct NFPs and IFPs made available
+    size_t run();
+
+    // Called on run()'s thread as requests finish, and once at the end
+    using ProgressCallback = std::function<void(size_t done, size_t total)>;
+    void setProgressCallback(ProgressCallback callback) { progress = std::move(callback); }
+
+    // Another thread may set this flag to end run() early; what was computed
+    // stays cached. Not owned.
+    void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+
+private:
+    const std::vector<Part>& parts;
+    nfpcalculator& nfpCalc;
+    std::vector<double> rotations;
+    int threads;
+    ProgressCallback progress;
+    const std::atomic<bool>* stopFlag = nullptr;
+};
+
+} // namespace nest
+
+#endif // NEST_NFPWARMUP_H
@@ -0,0 +1,95 @@
+#ifndef NEST_OPENHASHMAP_H
+#define NEST_OPENHASHMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace nest {
+
+// Open-addressing hash map with linear probing, for the geometry caches.
+// Key provides hash() and operator==. Values live in a deque so references
+// returned by find() and insert() stay valid while the table grows.
+template <typename Key, typename Value>
+class OpenHashMap
+{
+public:
+    explicit OpenHashMap(size_t initialCapacity = 64)
+    {
+        size_t capacity = 16;
+        while (capacity < initialCapacity) capacity <<= 1;
+        slots.assign(capacity, Slot());
+    }
+
+    const Value* find(const Key& key) const
+    {
+        const uint64_t hash = key.hash();
+        const size_t mask = slots.size() - 1;
+        for (size_t i = size_t(hash) & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots[i];
+            if (slot.index < 0) return nullptr;
+            if (slot.hash == hash && entries[slot.index].first == key) return &entries[slot.index].second;
+        }
+    }
+
+    // Insert or overwrite
+    Value& insert(const Key& key, Value value)
+    {
+        if ((entries.size() + 1) * 10 > slots.size() * 7) grow(); // Keep load below 0.7
+        const uint64_t hash = key.hash();
+        const size_t mask = slots.size() - 1;
+        size_t i = size_t(hash) & mask;
+        for (; slots[i].index >= 0; i = (i + 1) & mask) {
+            if (slots[i].hash == hash && entries[slots[i].index].first == key) {
+                return entries[slots[i].index].second = std::move(value);
+            }
+        }
+        slots[i] = {hash, int64_t(entries.size())};
+        entries.emplace_back(key, std::move(value));
+        return entries.back().second;
+    }
+
+    size_t size() const { return entries.size(); }
+    bool isEmpty() const { return entries.empty(); }
+
+    void clear()
+    {
+        entries.clear();
+        slots.assign(slots.size(), Slot());
+    }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const
+    {
+        for (const auto& entry : entries) fn(entry.first, entry.second);
+    }
+
+private:
+    struct Slot
+    {
+        uint64_t hash = 0;
+        int64_t index = -1; // Into entries, -1 when empty
+    };
+
+    void grow()
+    {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        const size_t mask = slots.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.index < 0) continue;
+            size_t i = size_t(slot.hash) & mask;
+            while (slots[i].index >= 0) i = (i + 1) & mask;
+            slots[i] = slot;
+        }
+    }
+
+    std::vector<Slot> slots;
+    std::deque<std::pair<Key, Value>> entries;
+};
+
+} // namespace nest
+
+#endif // NEST_OPENHASHMAP_H
@@ -0,0 +1,91 @@
+#ifndef NEST_PART_H
+#define NEST_PART_H
+
+#include "cavity.h"
+#include "fixedpoint.h"
+#include "geometry.h"
+#include "geometryhash.h"
+#include <cmath>
+#include <string>
+
+namespace nest {
+
+// A part to be nested: its outline in local coordinates plus the uniform
+// scale the user applied to it. The engine always works on the outline
+// rotated and scaled about the local origin.
+struct Part
+{
+    std::string name;
+    Polygon outline;
+    double scale = 1.0;
+    uint64_t hash = 0; // geometryHash(outline), and of holes; parts with equal hashes share cached NFPs
+
+    // Inner rings in local coordinates: material-free regions inside the
+    // outline, e.g. the opening of a frame. Overlap tests let parts sit in them.
+    std::vector<Polygon> holes;
+
+    // Where smaller parts may nest, largest first. Derived from the outline
+    // and holes alone, so parts with equal hashes have equal cavities.
+    std::vector<Cavity> cavities;
+
+    // The outline is unchanged by a turn of 360/symmetry degrees about
+    // symmetryCenter; 1 if it has no rotational symmetry
+    int symmetry = 1;
+    Point symmetryCenter;
+};
+
+inline Part makePart(const std::string& name, const Polygon& outline, double scale = 1.0,
+                     const std::vector<Polygon>& holes = {})
+{
+    Part part;
+    part.name = name;
+    part.outline = outline;
+    snapToGrid(part.outline);
+    part.scale = scale;
+    part.hash = geometryHash(part.outline);
+    part.holes = holes;
+    for (Polygon& hole : part.holes) {
+        snapToGrid(hole);
+        part.hash = hashCombine(part.hash, geometryHash(hole));
+    }
+    part.cavities = detectCavities(part.outline, part.holes);
+    // Holes need not share the outline's symmetry
+    if (part.holes.empty()) part.symmetry = rotationalSymmetry(part.outline, part.symmetryCenter);
+    return part;
+}
+
+// The rotation in [0, 360/symmetry) whose outline is the one at rotation,
+// moved by symmetryShift(). Snapped outlines only match to within the grid,
+// so fixed-point mode keeps every rotation.
+inline double canonicalRotation(const Part& part, double rotation)
+{
+    if (part.symmetry <= 1 || gridEnabled()) return rotation;
+    const double period = 360.0 / part.symmetry;
+    return rotation - period * std::floor(rotation / period);
+}
+
+// Offset from the scaled outline at canonicalRotation() to the one at rotation
+inline Point symmetryShift(const Part& part, double rotation)
+{
+    const double canonical = canonicalRotation(part, rotation);
+    if (canonical == rotation) return Point();
+    return (rotated(part.symmetryCenter, rotation) - rotated(part.symmetryCenter, canonical)) * part.scale;
+}
+
+// Where a part ends up: rotation in degrees about its local origin, then a
+// translation to position.
+struct Placement
+{
+    Point position;
+    double rotation = 0.0;
+};
+
+// Outline of a part in placed (scene) coordinates
+inline Polygon placedOutline(const Part& part, const Placement& placement)
+{
+    return transformed(part.outline, placement.rotation, part.scale, placement.position);
+}
+
+} // namespace nest
+
+#endif // NEST_PART_H
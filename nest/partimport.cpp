@@ -0,0 +1,33 @@
+#include "partimport.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+namespace nest {
+
+bool importFile(const std::string& path, PartLibrary& library, const ImportOptions& options, std::string& error)
+{
+    const size_t dot = path.find_last_of('.');
+    std::string extension = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+    if (extension != "svg" && extension != "dxf") {
+        error = path + ": not an .svg or .dxf file";
+        return false;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        error = path + ": cannot open";
+        return false;
+    }
+    // Large reads; the importers pull a character or a line at a time
+    char buffer[1 << 16];
+    file.rdbuf()->pubsetbuf(buffer, sizeof buffer);
+
+    const bool ok = extension == "svg" ? importSvg(file, library, options, error) : importDxf(file, library, options, error);
+    if (!ok) error = path + ": " + error;
+    return ok;
+}
+
+} // namespace nest
@@ -0,0 +1,38 @@
+#ifndef NEST_PARTIMPORT_H
+#define NEST_PARTIMPORT_H
+
+#include "partlibrary.h"
+#include <istream>
+#include <string>
+
+// Part outlines from SVG and DXF drawings. Files are read as a stream and
+// curves are flattened as they are met, so only the polygons are kept, not
+// the document. Closed shapes become parts; a shape inside another is a
+// hole of that part, where smaller parts may nest, and a shape inside a
+// hole is a part again.
+// Open paths are skipped, except that DXF lines, arcs and splines whose
+// ends meet are chained into closed outlines.
+namespace nest {
+
+struct ImportOptions
+{
+    double tolerance = 0.1; // Largest distance between a curve and its polygon, after scaling
+    double scale = 1.0;     // Drawing units to part units
+};
+
+// SVG: path, polygon, polyline, rect, circle and ellipse, with transforms.
+// Anything under defs, clipPath, mask, marker, pattern or symbol is not
+// drawn and is skipped; use elements are not expanded.
+bool importSvg(std::istream& in, PartLibrary& library, const ImportOptions& options, std::string& error);
+
+// DXF (ASCII): LWPOLYLINE and POLYLINE with bulges, CIRCLE, ELLIPSE, ARC,
+// LINE and SPLINE in the ENTITIES section. Block inserts are not expanded.
+// Parts are named by layer.
+bool importDxf(std::istream& in, PartLibrary& library, const ImportOptions& options, std::string& error);
+
+// Either of the above by file extension, .svg or .dxf in any case
+bool importFile(const std::string& path, PartLibrary& library, const ImportOptions& options, std::string& error);
+
+} // namespace nest
+
+#endif // NEST_PARTIMPORT_H
@@ -0,0 +1,82 @@
+#include "partlibrary.h"
+
+namespace nest {
+
+size_t PartLibrary::add(const std::string& name, const Polygon& outline, int quantity,
+                        const std::vector<Polygon>& holes)
+{
+    // Position in the source file is not part of a part's geometry
+    const Rect box = boundingRect(outline);
+    scratch.clear();
+    for (const Point& p : outline) scratch.push_back({p.x - box.minX, p.y - box.minY});
+    const size_t outlineCount = scratch.size();
+
+    uint64_t hash = geometryHash(scratch);
+    for (const Polygon& hole : holes) {
+        const size_t start = scratch.size();
+        for (const Point& p : hole) scratch.push_back({p.x - box.minX, p.y - box.minY});
+        hash = hashCombine(hash, geometryHash(Polygon(scratch.begin() + start, scratch.end())));
+    }
+    auto found = byHash.find(hash);
+    if (found != byHash.end()) {
+        entries[found->second].quantity += quantity;
+        return found->second;
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.first = arena.size();
+    entry.count = outlineCount;
+    entry.hash = hash;
+    entry.quantity = quantity;
+    entry.firstHole = holeRings.size();
+    entry.holeCount = holes.size();
+    size_t next = arena.size() + outlineCount;
+    for (const Polygon& hole : holes) {
+        holeRings.push_back({next, hole.size()});
+        next += hole.size();
+    }
+    arena.insert(arena.end(), scratch.begin(), scratch.end());
+    entries.push_back(entry);
+    byHash.emplace(hash, entries.size() - 1);
+    return entries.size() - 1;
+}
+
+Polygon PartLibrary::outline(size_t index) const
+{
+    const Point* first = vertices(index);
+    return Polygon(first, first + entries[index].count);
+}
+
+std::vector<Polygon> PartLibrary::holes(size_t index) const
+{
+    std::vector<Polygon> result;
+    const Entry& entry = entries[index];
+    for (size_t h = entry.firstHole; h < entry.firstHole + entry.holeCount; ++h) {
+        const Point* first = arena.data() + holeRings[h].first;
+        result.emplace_back(first, first + holeRings[h].count);
+    }
+    return result;
+}
+
+Part PartLibrary::part(size_t index) const
+{
+    return makePart(entries[index].name, outline(index), 1.0, holes(index));
+}
+
+size_t PartLibrary::partCount() const
+{
+    size_t total = 0;
+    for (const Entry& entry : entries) total += size_t(entry.quantity);
+    return total;
+}
+
+void PartLibrary::clear()
+{
+    arena.clear();
+    entries.clear();
+    holeRings.clear();
+    byHash.clear();
+}
+
+} // namespace nest
@@ -0,0 +1,64 @@
+#ifndef NEST_PARTLIBRARY_H
+#define NEST_PARTLIBRARY_H
+
+#include "part.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace nest {
+
+// Imported outlines, all in one contiguous vertex arena indexed by offset,
+// so a file with thousands of parts costs one growing allocation rather
+// than one per part. Each outline is moved so its bounding box starts at
+// the origin and identical outlines, by geometry hash, are stored once with
+// a quantity. A part's holes go into the arena after its outline.
+class PartLibrary
+{
+public:
+    struct Entry
+    {
+        std::string name;   // Of the first copy seen
+        size_t first = 0;   // Offset of the first vertex in the arena
+        size_t count = 0;
+        uint64_t hash = 0;  // geometryHash of the stored outline, combined with its holes'
+        int quantity = 0;
+        size_t firstHole = 0; // Index of its first hole in holeRings
+        size_t holeCount = 0;
+    };
+
+    // Adds quantity copies of outline with holes, in the outline's
+    // coordinates, or counts them against an identical part already added.
+    // Returns the entry index.
+    size_t add(const std::string& name, const Polygon& outline, int quantity = 1,
+               const std::vector<Polygon>& holes = {});
+
+    size_t size() const { return entries.size(); }
+    const Entry& entry(size_t index) const { return entries[index]; }
+    const Point* vertices(size_t index) const { return arena.data() + entries[index].first; }
+    Polygon outline(size_t index) const;
+    std::vector<Polygon> holes(size_t index) const;
+    Part part(size_t index) const;
+
+    size_t vertexCount() const { return arena.size(); }
+    size_t partCount() const; // Copies included
+    void clear();
+
+private:
+    struct Span
+    {
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    std::vector<Point> arena;
+    std::vector<Entry> entries;
+    std::vector<Span> holeRings; // Where each hole's vertices are in the arena
+    std::unordered_map<uint64_t, size_t> byHash;
+    Polygon scratch;
+};
+
+} // namespace nest
+
+#endif // NEST_PARTLIBRARY_H
@@ -0,0 +1,116 @@
+#include "parttable.h"
+#include "fixedpoint.h"
+#include "nfpkey.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+PartTable::PartTable(const std::vector<Part>& parts, const std::vector<double>& rotations)
+{
+    for (double rotation : rotations) {
+        const int32_t key = rotationKey(rotation);
+        if (std::find(rotationKeys.begin(), rotationKeys.end(), key) != rotationKeys.end()) continue;
+        this->rotations.push_back(rotation);
+        rotationKeys.push_back(key);
+    }
+
+    size_t total = 0;
+    for (const Part& part : parts) {
+        first.push_back(total);
+        counts.push_back(uint32_t(part.outline.size()));
+        total += part.outline.size() * this->rotations.size();
+    }
+    points.reserve(total);
+    const size_t entries = parts.size() * this->rotations.size();
+    boxes.reserve(entries);
+    areas.reserve(entries);
+    convex.reserve(entries);
+
+    for (const Part& part : parts) {
+        // Rotation and uniform scaling preserve both
+        const double area = std::abs(signedArea(part.outline)) * part.scale * part.scale;
+        const bool partConvex = nest::isConvex(part.outline);
+        for (double rotation : this->rotations) {
+            // On the fixed-point grid, as the NFPs are. Vertices are snapped one
+            // by one so every rotation keeps the same count; snapping may bend
+            // a convex outline.
+            Polygon outline = transformed(part.outline, rotation, part.scale);
+            for (Point& p : outline) p = snapped(p);
+            points.insert(points.end(), outline.begin(), outline.end());
+            boxes.push_back(boundingRect(outline));
+            areas.push_back(area);
+            convex.push_back(gridEnabled() ? nest::isConvex(outline) : partConvex);
+        }
+    }
+
+    for (const Part& part : parts) {
+        cavityFirst.push_back(cavityAreas.size());
+        cavityCounts.push_back(uint32_t(part.cavities.size()));
+        for (const Cavity& cavity : part.cavities) cavityAreas.push_back(cavity.area * part.scale * part.scale);
+        for (double rotation : this->rotations) {
+            for (const Cavity& cavity : part.cavities) {
+                cavityBoxes.push_back(boundingRect(transformed(cavity.region, rotation, part.scale)));
+            }
+        }
+    }
+
+    size_t holeTotal = 0;
+    for (const Part& part : parts) {
+        holeFirst.push_back(holeTotal);
+        holeCounts.push_back(uint32_t(part.holes.size()));
+        holeTotal += part.holes.size();
+        for (double rotation : this->rotations) {
+            for (const Polygon& hole : part.holes) {
+                Polygon placed = transformed(hole, rotation, part.scale);
+                for (Point& p : placed) p = snapped(p);
+                holeBoxes.push_back(boundingRect(placed));
+                holes.push_back(std::move(placed));
+            }
+        }
+    }
+}
+
+size_t PartTable::cavitiesAtLeast(size_t part, double area) const
+{
+    const auto first = cavityAreas.begin() + cavityFirst[part];
+    return std::partition_point(first, first + cavityCounts[part], [area](double a) { return a >= area; }) - first;
+}
+
+size_t PartTable::slot(double rotation) const
+{
+    const int32_t key = rotationKey(rotation);
+    for (size_t i = 0; i < rotationKeys.size(); ++i) {
+        if (rotationKeys[i] == key) return i;
+    }
+    return NoSlot;
+}
+
+std::vector<size_t> PartTable::distinctSlots(const Part& part, const std::vector<size_t>& slots) const
+{
+    std::vector<size_t> distinct;
+    std::vector<int32_t> keys;
+    for (size_t slot : slots) {
+        const int32_t key = rotationKey(canonicalRotation(part, rotations[slot]));
+        if (std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+        keys.push_back(key);
+        distinct.push_back(slot);
+    }
+    return distinct;
+}
+
+void PartTable::place(size_t part, size_t slot, const Point& position, Polygon& out) const
+{
+    const Point* source = vertices(part, slot);
+    out.resize(counts[part]);
+    for (size_t i = 0; i < out.size(); ++i) out[i] = source[i] + position;
+}
+
+void PartTable::placeHole(size_t part, size_t slot, size_t hole, const Point& position, Polygon& out) const
+{
+    const Polygon& source = holes[holeEntry(part, slot, hole)];
+    out.resize(source.size());
+    for (size_t i = 0; i < out.size(); ++i) out[i] = source[i] + position;
+}
+
+} // namespace nest
@@ -0,0 +1,86 @@
+#ifndef NEST_PARTTABLE_H
+#define NEST_PARTTABLE_H
+
+#include "part.h"
+#include <cstdint>
+#include <vector>
+
+namespace nest {
+
+// Every part rotated and scaled once for each rotation the optimizer may use,
+// so moves only translate table entries: no trigonometry, no allocation.
+// Entries are stored column-wise: one contiguous vertex array for all parts
+// and rotations, and parallel arrays of bounds, areas and convexity flags
+// indexed by part * rotationCount() + slot. Cavity bounds and holes follow
+// the same pattern with each part's cavities or holes innermost.
+class PartTable
+{
+public:
+    static const size_t NoSlot = size_t(-1);
+
+    PartTable() = default;
+    PartTable(const std::vector<Part>& parts, const std::vector<double>& rotations);
+
+    size_t partCount() const { return counts.size(); }
+    size_t rotationCount() const { return rotations.size(); }
+    double rotation(size_t slot) const { return rotations[slot]; }
+    // Slot of a rotation in degrees, matched to the millidegree, or NoSlot
+    size_t slot(double rotation) const;
+    // The slots, in order, whose outlines of part differ by more than a move:
+    // of those a symmetry period apart only the first is kept
+    std::vector<size_t> distinctSlots(const Part& part, const std::vector<size_t>& slots) const;
+
+    const Point* vertices(size_t part, size_t slot) const { return &points[first[part] + slot * counts[part]]; }
+    size_t vertexCount(size_t part) const { return counts[part]; }
+    // Bounds relative to the placement position
+    const Rect& bounds(size_t part, size_t slot) const { return boxes[entry(part, slot)]; }
+    double area(size_t part, size_t slot) const { return areas[entry(part, slot)]; }
+    bool isConvex(size_t part, size_t slot) const { return convex[entry(part, slot)] != 0; }
+
+    // Cavities in Part::cavities order (largest first), areas scaled
+    size_t cavityCount(size_t part) const { return cavityCounts[part]; }
+    double cavityArea(size_t part, size_t cavity) const { return cavityAreas[cavityFirst[part] + cavity]; }
+    const Rect& cavityBounds(size_t part, size_t slot, size_t cavity) const
+    {
+        return cavityBoxes[cavityFirst[part] * rotations.size() + slot * cavityCounts[part] + cavity];
+    }
+    // Leading cavities with at least the given area: the only ones a part that big can use
+    size_t cavitiesAtLeast(size_t part, double area) const;
+
+    // Holes in Part::holes order, rotated and scaled like the outline; bounds
+    // relative to the placement position
+    size_t holeCount(size_t part) const { return holeCounts[part]; }
+    const Rect& holeBounds(size_t part, size_t slot, size_t hole) const { return holeBoxes[holeEntry(part, slot, hole)]; }
+
+    // Placed outline of part at slot, written into out so its buffer is reused
+    void place(size_t part, size_t slot, const Point& position, Polygon& out) const;
+    void placeHole(size_t part, size_t slot, size_t hole, const Point& position, Polygon& out) const;
+
+private:
+    size_t entry(size_t part, size_t slot) const { return part * rotations.size() + slot; }
+    size_t holeEntry(size_t part, size_t slot, size_t hole) const
+    {
+        return holeFirst[part] * rotations.size() + slot * holeCounts[part] + hole;
+    }
+
+    std::vector<double> rotations;
+    std::vector<int32_t> rotationKeys;
+    std::vector<Point> points;
+    std::vector<size_t> first;         // Per part: its first vertex in points
+    std::vector<uint32_t> counts;      // Per part: vertices per rotation
+    std::vector<Rect> boxes;
+    std::vector<double> areas;
+    std::vector<char> convex;
+    std::vector<size_t> cavityFirst;    // Per part: its first cavity in cavityAreas
+    std::vector<uint32_t> cavityCounts; // Per part
+    std::vector<double> cavityAreas;
+    std::vector<Rect> cavityBoxes;
+    std::vector<size_t> holeFirst;      // Per part: its first hole, counted over all parts
+    std::vector<uint32_t> holeCounts;   // Per part
+    std::vector<Polygon> holes;         // Indexed like cavityBoxes
+    std::vector<Rect> holeBoxes;
+};
+
+} // namespace nest
+
+#endif // NEST_PARTTABLE_H
@@ -0,0 +1,308 @@
+#include "polygonunion.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <unordered_map>
+
+namespace nest {
+
+namespace {
+
+struct Split
+{
+    double t;
+    Point p;
+};
+
+struct Edge
+{
+    Point a;
+    Point b;
+    int owner; // Area the edge bounds; only edges of different areas are intersected
+    Rect box;
+    std::vector<Split> splits;
+};
+
+struct Fragment
+{
+    int from;
+    int to;
+};
+
+double length(const Point& v)
+{
+    return std::sqrt(v.x * v.x + v.y * v.y);
+}
+
+// Record where e and f cross or overlap. Points that land on an existing
+// endpoint reuse its exact coordinates so chaining can match them.
+void intersectEdges(Edge& e, Edge& f, double tol)
+{
+    const Point r = e.b - e.a;
+    const Point s = f.b - f.a;
+    const double lr = length(r);
+    const double ls = length(s);
+    if (lr == 0.0 || ls == 0.0) return;
+    const double tr = tol / lr;
+    const double ts = tol / ls;
+    const double denom = r.x * s.y - r.y * s.x;
+
+    if (std::abs(denom) > 1e-12 * lr * ls) {
+        const Point qp = f.a - e.a;
+        const double t = (qp.x * s.y - qp.y * s.x) / denom;
+        const double u = (qp.x * r.y - qp.y * r.x) / denom;
+        if (t < -tr || t > 1 + tr || u < -ts || u > 1 + ts) return;
+        const bool tEnd = t <= tr || t >= 1 - tr;
+        const bool uEnd = u <= ts || u >= 1 - ts;
+        if (tEnd && uEnd) return;
+        if (tEnd) {
+            f.splits.push_back({u, t <= tr ? e.a : e.b});
+        } else if (uEnd) {
+            e.splits.push_back({t, u <= ts ? f.a : f.b});
+        } else {
+            const Point p = e.a + r * t;
+            e.splits.push_back({t, p});
+            f.splits.push_back({u, p});
+        }
+        return;
+    }
+
+    // Parallel: only collinear overlaps matter
+    if (std::abs(crossProduct(e.a, e.b, f.a)) / lr > tol || std::abs(crossProduct(e.a, e.b, f.b)) / lr > tol) return;
+    auto project = [](const Point& p, const Point& origin, const Point& dir, double len) {
+        const Point d = p - origin;
+        return (d.x * dir.x + d.y * dir.y) / (len * len);
+    };
+    for (const Point& p : {f.a, f.b}) {
+        const double t = project(p, e.a, r, lr);
+        if (t > tr && t < 1 - tr) e.splits.push_back({t, p});
+    }
+    for (const Point& p : {e.a, e.b}) {
+        const double u = project(p, f.a, s, ls);
+        if (u > ts && u < 1 - ts) f.splits.push_back({u, p});
+    }
+}
+
+// Welds points closer than the tolerance into shared vertex ids
+class VertexWelder
+{
+public:
+    explicit VertexWelder(double tol) : cell(tol * 4) {}
+
+    int id(const Point& p)
+    {
+        const long long cx = (long long)std::floor(p.x / cell);
+        const long long cy = (long long)std::floor(p.y / cell);
+        for (long long dx = -1; dx <= 1; ++dx) {
+            for (long long dy = -1; dy <= 1; ++dy) {
+                auto it = grid.find(key(cx + dx, cy + dy));
+                if (it == grid.end()) continue;
+                for (int v : it->second) {
+                    if (std::abs(points[v].x - p.x) <= cell && std::abs(points[v].y - p.y) <= cell) return v;
+                }
+            }
+        }
+        points.push_back(p);
+        grid[key(cx, cy)].push_back(int(points.size() - 1));
+        return int(points.size() - 1);
+    }
+
+    std::vector<Point> points;
+
+private:
+    static long long key(long long x, long long y) { return x * 73856093LL ^ y * 19349663LL; }
+
+    double cell;
+    std::unordered_map<long long, std::vector<int>> grid;
+};
+
+// Strictly inside a counter-clockwise convex polygon, by more than tol
+bool strictlyInside(const Polygon& poly, const Point& p, double tol)
+{
+    const size_t n = poly.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = poly[i];
+        const Point& b = poly[(i + 1) % n];
+        const double len = length(b - a);
+        if (len == 0.0) continue;
+        if (crossProduct(a, b, p) / len <= tol) return false;
+    }
+    return true;
+}
+
+// Strictly inside the area the loops bound, by the even-odd rule, and more
+// than tol from all of them
+bool strictlyInside(const std::vector<Polygon>& loops, const Point& p, double tol)
+{
+    bool inside = false;
+    for (const Polygon& loop : loops) {
+        const size_t n = loop.size();
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            const Point& a = loop[j];
+            const Point& b = loop[i];
+            const Point d = b - a;
+            const double len2 = d.x * d.x + d.y * d.y;
+            const double t = len2 > 0 ? std::clamp(((p.x - a.x) * d.x + (p.y - a.y) * d.y) / len2, 0.0, 1.0) : 0.0;
+            if (length(p - (a + d * t)) <= tol) return false;
+            if ((a.y > p.y) != (b.y > p.y) && p.x < a.x + (p.y - a.y) * d.x / d.y) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+void addEdges(const Polygon& loop, int owner, std::vector<Edge>& edges)
+{
+    for (size_t i = 0; i < loop.size(); ++i) {
+        Edge e{loop[i], loop[(i + 1) % loop.size()], owner, Rect(), {}};
+        e.box = boundingRect({e.a, e.b});
+        edges.push_back(std::move(e));
+    }
+}
+
+// Boundary of the union of several areas, given the edges bounding each.
+// Edges are split where they meet another area's, fragments that
+// covered(midpoint, owner) puts strictly inside another area are dropped and
+// the rest are chained into loops.
+template <typename Covered>
+std::vector<Polygon> traceUnion(std::vector<Edge>& edges, double tol, const Covered& covered)
+{
+    // Sweep over x to find candidate edge pairs
+    std::vector<int> order(edges.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = int(i);
+    std::sort(order.begin(), order.end(), [&edges](int a, int b) { return edges[a].box.minX < edges[b].box.minX; });
+    for (size_t i = 0; i < order.size(); ++i) {
+        Edge& e = edges[order[i]];
+        for (size_t j = i + 1; j < order.size(); ++j) {
+            Edge& f = edges[order[j]];
+            if (f.box.minX > e.box.maxX + tol) break;
+            if (f.owner == e.owner) continue;
+            if (f.box.minY > e.box.maxY + tol || e.box.minY > f.box.maxY + tol) continue;
+            intersectEdges(e, f, tol);
+        }
+    }
+
+    // Split edges into fragments and keep those on the union boundary. Most
+    // fragments are covered, so only the rest are welded.
+    VertexWelder welder(tol);
+    std::vector<Fragment> fragments;
+    std::vector<Point> chain;
+    for (Edge& e : edges) {
+        std::sort(e.splits.begin(), e.splits.end(), [](const Split& a, const Split& b) { return a.t < b.t; });
+        chain.assign(1, e.a);
+        for (const Split& s : e.splits) chain.push_back(s.p);
+        chain.push_back(e.b);
+
+        for (size_t i = 0; i + 1 < chain.size(); ++i) {
+            if (covered((chain[i] + chain[i + 1]) * 0.5, e.owner)) continue;
+            const int from = welder.id(chain[i]);
+            const int to = welder.id(chain[i + 1]);
+            if (from != to) fragments.push_back({from, to});
+        }
+    }
+
+    // Coincident fragments: same direction keep one, opposite directions cancel
+    std::map<std::pair<int, int>, int> directed;
+    for (const Fragment& f : fragments) ++directed[{f.from, f.to}];
+    std::vector<std::vector<int>> outgoing(welder.points.size());
+    std::vector<Fragment> boundary;
+    for (const Fragment& f : fragments) {
+        auto it = directed.find({f.from, f.to});
+        if (it->second == 0) continue; // Already emitted
+        if (directed.count({f.to, f.from})) continue;
+        it->second = 0;
+        outgoing[f.from].push_back(int(boundary.size()));
+        boundary.push_back(f);
+    }
+
+    // Chain into loops, taking the sharpest left turn at shared vertices
+    std::vector<bool> used(boundary.size(), false);
+    std::vector<Polygon> loops;
+    const std::vector<Point>& pts = welder.points;
+    for (size_t start = 0; start < boundary.size(); ++start) {
+        if (used[start]) continue;
+        Polygon loop;
+        size_t current = start;
+        while (true) {
+            used[current] = true;
+            const Fragment& f = boundary[current];
+            loop.push_back(pts[f.from]);
+            if (f.to == boundary[start].from) break;
+
+            const Point in = pts[f.to] - pts[f.from];
+            int next = -1;
+            double bestTurn = -10.0;
+            for (int candidate : outgoing[f.to]) {
+                if (used[candidate]) continue;
+                const Point out = pts[boundary[candidate].to] - pts[boundary[candidate].from];
+                const double turn = std::atan2(in.x * out.y - in.y * out.x, in.x * out.x + in.y * out.y);
+                if (turn > bestTurn) {
+                    bestTurn = turn;
+                    next = candidate;
+                }
+            }
+            if (next < 0) break; // Open chain from numerical trouble; drop it below
+            current = size_t(next);
+        }
+        if (boundary[current].to != boundary[start].from) continue;
+        removeCollinear(loop);
+        if (loop.size() >= 3 && std::abs(signedArea(loop)) > tol) loops.push_back(std::move(loop));
+    }
+    return loops;
+}
+
+// Sets of up to this many pieces are traced in one go. Larger ones are
+// halved and the halves' unions merged, so edges buried inside one half are
+// never split against the other: one pass over hundreds of overlapping sums
+// splits their edges into hundreds of thousands of fragments.
+const size_t kLeafPieces = 8;
+
+std::vector<Polygon> unionOfRange(const std::vector<Polygon>& pieces, const std::vector<Rect>& pieceBounds,
+                                  size_t begin, size_t end, double tol)
+{
+    std::vector<Edge> edges;
+    if (end - begin <= kLeafPieces) {
+        for (size_t p = begin; p < end; ++p) {
+            if (pieces[p].size() >= 3) addEdges(pieces[p], int(p), edges);
+        }
+        return traceUnion(edges, tol, [&](const Point& mid, int owner) {
+            for (size_t p = begin; p < end; ++p) {
+                if (int(p) != owner && pieceBounds[p].contains(mid) && strictlyInside(pieces[p], mid, tol)) return true;
+            }
+            return false;
+        });
+    }
+
+    const size_t middle = begin + (end - begin) / 2;
+    const std::vector<Polygon> halves[2] = {unionOfRange(pieces, pieceBounds, begin, middle, tol),
+                                            unionOfRange(pieces, pieceBounds, middle, end, tol)};
+    if (halves[0].empty()) return halves[1];
+    if (halves[1].empty()) return halves[0];
+    Rect halfBounds[2];
+    for (int h = 0; h < 2; ++h) {
+        for (const Polygon& loop : halves[h]) {
+            addEdges(loop, h, edges);
+            halfBounds[h] = halfBounds[h].united(boundingRect(loop));
+        }
+    }
+    return traceUnion(edges, tol, [&](const Point& mid, int owner) {
+        return halfBounds[1 - owner].contains(mid) && strictlyInside(halves[1 - owner], mid, tol);
+    });
+}
+
+} // namespace
+
+std::vector<Polygon> unionOfConvex(const std::vector<Polygon>& pieces)
+{
+    Rect bounds;
+    std::vector<Rect> pieceBounds;
+    pieceBounds.reserve(pieces.size());
+    for (const Polygon& piece : pieces) {
+        pieceBounds.push_back(boundingRect(piece));
+        bounds = bounds.united(pieceBounds.back());
+    }
+    if (bounds.isEmpty()) return {};
+    const double tol = std::max({bounds.width(), bounds.height(), 1.0}) * 1e-9;
+    return unionOfRange(pieces, pieceBounds, 0, pieces.size(), tol);
+}
+
+} // namespace nest
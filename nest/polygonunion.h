@@ -0,0 +1,17 @@
+#ifndef NEST_POLYGONUNION_H
+#define NEST_POLYGONUNION_H
+
+#include "geometry.h"
+
+namespace nest {
+
+// Boundary of the union of convex, counter-clockwise polygons. Edges are split
+// at every intersection, fragments strictly inside another piece are dropped
+// and the rest are chained into closed loops; large sets are unioned in
+// halves and the results merged the same way. Outer boundaries come back
+// counter-clockwise (positive signedArea), holes in the union clockwise.
+std::vector<Polygon> unionOfConvex(const std::vector<Polygon>& pieces);
+
+} // namespace nest
+
+#endif // NEST_POLYGONUNION_H
@@ -0,0 +1,61 @@
+#include "shapes.h"
+#include <cmath>
+
+namespace nest {
+
+const std::vector<std::string>& shapeNames()
+{
+    static const std::vector<std::string> names = {"Curve C", "C", "Star", "Rectangle", "Ellipse", "Triangle", "Square"};
+    return names;
+}
+
+static Polygon ellipse(int sides, double rx, double ry)
+{
+    Polygon poly;
+    for (int i = 0; i < sides; ++i) {
+        const double angle = 2 * Pi * i / sides;
+        poly.push_back({rx * std::cos(angle), ry * std::sin(angle)});
+    }
+    return poly;
+}
+
+static Polygon star(int points, double outerRadius, double innerRadius)
+{
+    Polygon poly;
+    for (int i = 0; i < points * 2; ++i) {
+        const double angle = Pi * i / points;
+        const double radius = (i % 2 == 0) ? outerRadius : innerRadius;
+        poly.push_back({radius * std::cos(angle), radius * std::sin(angle)});
+    }
+    return poly;
+}
+
+// A 270 degree outer arc of the 100x100 circle, then the inner arc of the
+// 60x60 one back. Angles run counter-clockwise on screen, as in QPainterPath.
+static Polygon curveC()
+{
+    Polygon poly;
+    for (int i = 0; i <= 25; ++i) {
+        const double angle = (45 + 270.0 * i / 25) * Pi / 180;
+        poly.push_back({50 + 50 * std::cos(angle), 50 - 50 * std::sin(angle)});
+    }
+    for (int i = 0; i < 25; ++i) {
+        const double angle = (315 - 270.0 * i / 24) * Pi / 180;
+        poly.push_back({50 + 30 * std::cos(angle), 50 - 30 * std::sin(angle)});
+    }
+    return poly;
+}
+
+Polygon shapeOutline(const std::string& name)
+{
+    if (name == "Rectangle") return {{-25, -25}, {25, -25}, {25, 25}, {-25, 25}};
+    if (name == "Ellipse") return ellipse(20, 25, 15);
+    if (name == "Triangle") return {{0, 0}, {50, 0}, {25, -50}};
+    if (name == "Square") return {{0, 0}, {50, 0}, {50, 50}, {0, 50}};
+    if (name == "C") return {{40, 0}, {-10, 0}, {-10, 90}, {40, 90}, {40, 78}, {10, 78}, {10, 12}, {40, 12}};
+    if (name == "Star") return star(5, 25, 10);
+    if (name == "Curve C") return curveC();
+    return Polygon();
+}
+
+} // namespace nest
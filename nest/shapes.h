@@ -0,0 +1,21 @@
+#ifndef NEST_SHAPES_H
+#define NEST_SHAPES_H
+
+#include "geometry.h"
+#include <string>
+#include <vector>
+
+namespace nest {
+
+// Names of the shapes the scene's toolbar can drop, in toolbar order
+const std::vector<std::string>& shapeNames();
+
+// Local outline of a named shape. The scene's drop handler builds its items
+// from these, so the bench and batch tools nest exactly what users do. Curve C
+// is its two arcs with 51 evenly spaced points. Unknown names give an empty
+// polygon.
+Polygon shapeOutline(const std::string& name);
+
+} // namespace nest
+
+#endif // NEST_SHAPES_H
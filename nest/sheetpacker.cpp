@@ -0,0 +1,95 @@
+#include "sheetpacker.h"
+#include "geometryhash.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace nest {
+
+SheetPacker::SheetPacker(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const SheetsConfig& config)
+    : parts(parts), nfpCalc(nfpCalc), config(config)
+{
+}
+
+SheetsResult SheetPacker::run()
+{
+    SheetsResult result;
+    result.placements.resize(parts.size());
+    result.sheets.assign(parts.size(), -1);
+    if (parts.empty() || !(config.sheetWidth > 0) || !(config.sheetHeight > 0)) return result;
+    const Rect sheet{0.0, 0.0, config.sheetWidth, config.sheetHeight};
+
+    // Fill sheet after sheet with what is left
+    std::vector<std::vector<size_t>> members; // Per sheet: indices into parts
+    std::vector<std::vector<Part>> sheetParts;
+    std::vector<std::vector<Placement>> filled;
+    std::vector<size_t> remaining(parts.size());
+    std::iota(remaining.begin(), remaining.end(), 0);
+    while (!remaining.empty()) {
+        if (stopFlag && stopFlag->load(std::memory_order_relaxed)) break;
+        std::vector<Part> subset;
+        subset.reserve(remaining.size());
+        for (size_t index : remaining) subset.push_back(parts[index]);
+
+        FillConfig fillConfig = config.fill;
+        fillConfig.objective = Objective::StripLength;
+        fillConfig.stripHeight = config.sheetHeight;
+        fillConfig.sheet = sheet;
+        BottomLeftFill placer(subset, nfpCalc, fillConfig);
+        placer.setStopFlag(stopFlag);
+        const NestResult fill = placer.run();
+        // Whatever an empty sheet cannot take, no sheet can
+        if (fill.unplaced.size() == subset.size()) break;
+
+        std::vector<char> left(subset.size(), 0);
+        for (size_t i : fill.unplaced) left[i] = 1;
+        members.emplace_back();
+        sheetParts.emplace_back();
+        filled.emplace_back();
+        std::vector<size_t> next;
+        for (size_t i = 0; i < subset.size(); ++i) {
+            if (left[i]) {
+                next.push_back(remaining[i]);
+                continue;
+            }
+            members.back().push_back(remaining[i]);
+            sheetParts.back().push_back(std::move(subset[i]));
+            filled.back().push_back(fill.placements[i]);
+        }
+        remaining.swap(next);
+    }
+
+    // Then improve every sheet at once, the cores shared out between them
+    const size_t sheetCount = members.size();
+    std::vector<NestResult> annealed(sheetCount);
+    if (config.annealSheets && sheetCount > 0) {
+        const int cores = config.threads > 0 ? config.threads : int(std::max(1u, std::thread::hardware_concurrency()));
+        const int threadsPerSheet = std::max(1, cores / int(sheetCount));
+        ThreadPool pool(std::min(cores, int(sheetCount)));
+        pool.parallelFor(sheetCount, [&](size_t s) {
+            AnnealConfig annealConfig = config.anneal;
+            annealConfig.objective = Objective::StripLength;
+            annealConfig.stripHeight = config.sheetHeight;
+            annealConfig.sheet = sheet;
+            annealConfig.threads = threadsPerSheet;
+            if (annealConfig.seed) annealConfig.seed = hashCombine(annealConfig.seed, uint64_t(s));
+            Annealer annealer(sheetParts[s], nfpCalc, annealConfig);
+            annealer.setStopFlag(stopFlag);
+            annealed[s] = annealer.run(filled[s]);
+        });
+    }
+
+    for (size_t s = 0; s < sheetCount; ++s) {
+        const std::vector<Placement>& placements = config.annealSheets ? annealed[s].placements : filled[s];
+        for (size_t k = 0; k < members[s].size(); ++k) {
+            result.placements[members[s][k]] = placements[k];
+            result.sheets[members[s][k]] = int(s);
+        }
+        result.moves += annealed[s].moves;
+    }
+    result.sheetCount = int(sheetCount);
+    return result;
+}
+
+} // namespace nest
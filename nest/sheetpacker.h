@@ -0,0 +1,57 @@
+#ifndef NEST_SHEETPACKER_H
+#define NEST_SHEETPACKER_H
+
+#include "bottomleftfill.h"
+#include <atomic>
+#include <vector>
+
+namespace nest {
+
+struct SheetsConfig
+{
+    double sheetWidth = 0.0;
+    double sheetHeight = 0.0;
+    // Per sheet. The objective, strip height and sheet are set by the packer,
+    // and so are the annealer's threads: the cores are shared out between the
+    // sheets. Its chains are kept, so a seed gives the same layouts anywhere.
+    FillConfig fill;
+    AnnealConfig anneal;
+    bool annealSheets = true; // false keeps the fill's layouts
+    int threads = 0;          // In all; 0 uses one per hardware core
+};
+
+struct SheetsResult
+{
+    std::vector<Placement> placements; // One per part, relative to its sheet's bottom-left corner
+    std::vector<int> sheets;           // Per part: its sheet from 0, or -1 if it fits on none
+    int sheetCount = 0;
+    long moves = 0;
+};
+
+// Multi-sheet bin packing: parts onto as few identical sheets as possible.
+// Sheets are filled one after another by a BottomLeftFill bounded to the
+// sheet, each taking the parts the previous ones had no room for, largest
+// first. Then every sheet is annealed on its own, all at once on a thread
+// pool, towards the shortest used length so the offcut is one piece; a
+// 20-sheet job keeps 20 cores busy.
+class SheetPacker
+{
+public:
+    SheetPacker(const std::vector<Part>& parts, nfpcalculator& nfpCalc, const SheetsConfig& config);
+
+    SheetsResult run();
+
+    // Another thread may set this flag to end run() early. Sheets not yet
+    // filled are not started; their parts are left without one. Not owned.
+    void setStopFlag(const std::atomic<bool>* flag) { stopFlag = flag; }
+
+private:
+    const std::vector<Part>& parts;
+    nfpcalculator& nfpCalc;
+    SheetsConfig config;
+    const std::atomic<bool>* stopFlag = nullptr;
+};
+
+} // namespace nest
+
+#endif // NEST_SHEETPACKER_H
@@ -0,0 +1,238 @@
+#include "simplify.h"
+#include "fixedpoint.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+
+namespace nest {
+
+namespace {
+
+// Vertices in a doubly linked ring. error[v] bounds how far any point of the
+// edge from v to next[v] lies from the original boundary.
+struct Ring
+{
+    Polygon points;
+    std::vector<size_t> prev, next;
+    std::vector<double> error;
+    std::vector<uint32_t> version; // Bumped whenever v's neighbourhood changes
+    std::vector<char> removed;
+    size_t count = 0;
+    int winding = 1; // Sign of the area: turns of this sign are convex
+};
+
+// Either cut vertex v off with the chord from prev to next, or extend the
+// edges into and out of the edge (v, next) until they meet at apex
+struct Operation
+{
+    size_t vertex = 0;
+    uint32_t version = 0;
+    bool extend = false;
+    Point apex;
+    double area = 0.0;        // Added area, smallest first
+    double errorBefore = 0.0; // Bound for the new edge ending at the apex, or for the chord
+    double errorAfter = 0.0;  // Bound for the new edge starting at the apex
+
+    bool operator<(const Operation& other) const { return area > other.area; }
+};
+
+double distance(const Point& a, const Point& b)
+{
+    return std::hypot(b.x - a.x, b.y - a.y);
+}
+
+double distanceToSegment(const Point& p, const Point& a, const Point& b)
+{
+    const Point d = b - a;
+    const double lengthSquared = d.x * d.x + d.y * d.y;
+    double t = lengthSquared > 0 ? ((p.x - a.x) * d.x + (p.y - a.y) * d.y) / lengthSquared : 0.0;
+    t = std::min(1.0, std::max(0.0, t));
+    return distance(p, a + d * t);
+}
+
+bool onSegment(const Point& p, const Point& a, const Point& b)
+{
+    return orientation(a, b, p) == 0 && p.x >= std::min(a.x, b.x) && p.x <= std::max(a.x, b.x) &&
+           p.y >= std::min(a.y, b.y) && p.y <= std::max(a.y, b.y);
+}
+
+// Closed segments meet anywhere but at an endpoint they share
+bool segmentsMeet(const Point& p, const Point& q, const Point& s, const Point& e)
+{
+    const int o1 = orientation(s, e, p), o2 = orientation(s, e, q);
+    const int o3 = orientation(p, q, s), o4 = orientation(p, q, e);
+    if (o1 * o2 < 0 && o3 * o4 < 0) return true;
+    auto touches = [](const Point& v, const Point& a, const Point& b) { return v != a && v != b && onSegment(v, a, b); };
+    return touches(p, s, e) || touches(q, s, e) || touches(s, p, q) || touches(e, p, q);
+}
+
+int turn(const Ring& ring, size_t v)
+{
+    return orientation(ring.points[ring.prev[v]], ring.points[v], ring.points[ring.next[v]]) * ring.winding;
+}
+
+// The rest of the ring, from last round to first, must stay clear of the
+// area an operation adds (region) and of the new edges, or the result
+// would no longer be simple
+bool staysSimple(const Ring& ring, size_t first, size_t last, const Polygon& region, const Polygon& newPath)
+{
+    const Rect box = boundingRect(region);
+    for (size_t k = last; k != first; k = ring.next[k]) {
+        const Point& p = ring.points[k];
+        const Point& q = ring.points[ring.next[k]];
+        if (std::max(p.x, q.x) < box.minX || std::min(p.x, q.x) > box.maxX || std::max(p.y, q.y) < box.minY ||
+            std::min(p.y, q.y) > box.maxY) {
+            continue;
+        }
+        if (k != last && std::find(region.begin(), region.end(), p) == region.end() && containsPoint(region, p)) {
+            return false;
+        }
+        for (size_t i = 0; i + 1 < newPath.size(); ++i) {
+            if (segmentsMeet(p, q, newPath[i], newPath[i + 1])) return false;
+        }
+    }
+    return true;
+}
+
+bool plan(const Ring& ring, size_t v, double tolerance, Operation& op)
+{
+    const size_t u = ring.prev[v], w = ring.next[v];
+    const Point& a = ring.points[u];
+    const Point& b = ring.points[v];
+    const Point& c = ring.points[w];
+    op.vertex = v;
+    op.version = ring.version[v];
+
+    if (turn(ring, v) <= 0) {
+        // Reflex or collinear: the chord a-c passes outside b. Every point of
+        // the chord is within the triangle's height of the path a-b-c.
+        if (ring.count <= 3) return false;
+        const double chord = distance(a, c);
+        const double twiceArea = std::abs(crossProduct(a, b, c));
+        op.extend = false;
+        op.errorBefore = (chord > 0 ? twiceArea / chord : distance(a, b)) + std::max(ring.error[u], ring.error[v]);
+        if (op.errorBefore > tolerance) return false;
+        op.area = twiceArea * 0.5;
+        return staysSimple(ring, u, w, {a, b, c}, {a, c});
+    }
+
+    // Convex pair b, c: extend a-b beyond b and d-c beyond c to the apex
+    if (turn(ring, w) <= 0) return false;
+    const Point& d = ring.points[ring.next[w]];
+    const Point ab = b - a, dc = c - d, bc = c - b;
+    const double denom = ab.x * dc.y - ab.y * dc.x;
+    if (denom == 0) return false;
+    const double t = (bc.x * dc.y - bc.y * dc.x) / denom;
+    const double s = (bc.x * ab.y - bc.y * ab.x) / denom;
+    if (!(t > 0 && s > 0)) return false;
+    const Point exact = b + ab * t;
+    op.apex = snapped(exact);
+    if (op.apex == a || op.apex == d) return false;
+    if (gridEnabled()) {
+        // Snapping may pull the apex inward; the old corner must stay covered
+        for (const Point& corner : {b, c}) {
+            if (orientation(a, op.apex, corner) * ring.winding < 0 || orientation(op.apex, d, corner) * ring.winding < 0) {
+                return false;
+            }
+        }
+    }
+
+    // Points of the extensions are within the apex's distance of edge b-c
+    const double reach = distanceToSegment(exact, b, c) + ring.error[v];
+    const double shift = distance(exact, op.apex);
+    op.extend = true;
+    op.errorBefore = std::max(ring.error[u], reach) + shift;
+    op.errorAfter = std::max(ring.error[w], reach) + shift;
+    if (op.errorBefore > tolerance || op.errorAfter > tolerance) return false;
+    op.area = std::abs(crossProduct(b, op.apex, c)) * 0.5;
+    return staysSimple(ring, u, ring.next[w], {a, b, c, d, op.apex}, {a, op.apex, d});
+}
+
+void apply(Ring& ring, const Operation& op)
+{
+    const size_t v = op.vertex;
+    const size_t u = ring.prev[v];
+    if (op.extend) {
+        // The apex takes v's place and v's successor goes
+        const size_t w = ring.next[v];
+        ring.points[v] = op.apex;
+        ring.error[u] = op.errorBefore;
+        ring.error[v] = op.errorAfter;
+        ring.next[v] = ring.next[w];
+        ring.prev[ring.next[w]] = v;
+        ring.removed[w] = 1;
+    } else {
+        ring.error[u] = op.errorBefore;
+        ring.next[u] = ring.next[v];
+        ring.prev[ring.next[v]] = u;
+        ring.removed[v] = 1;
+    }
+    --ring.count;
+}
+
+} // namespace
+
+Polygon simplifyOutward(const Polygon& poly, double tolerance)
+{
+    Ring ring;
+    ring.points = poly;
+    removeCollinear(ring.points);
+    const size_t n = ring.points.size();
+    const double area = signedArea(ring.points);
+    if (!(tolerance > 0) || n < 4 || area == 0) return poly;
+
+    ring.winding = area > 0 ? 1 : -1;
+    ring.count = n;
+    ring.prev.resize(n);
+    ring.next.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        ring.prev[i] = (i + n - 1) % n;
+        ring.next[i] = (i + 1) % n;
+    }
+    ring.error.assign(n, 0.0);
+    ring.version.assign(n, 0);
+    ring.removed.assign(n, 0);
+
+    std::priority_queue<Operation> queue;
+    auto replan = [&](size_t v) {
+        ++ring.version[v];
+        Operation op;
+        if (plan(ring, v, tolerance, op)) queue.push(op);
+    };
+    for (size_t v = 0; v < n; ++v) replan(v);
+
+    while (!queue.empty() && ring.count > 3) {
+        Operation op = queue.top();
+        queue.pop();
+        if (ring.removed[op.vertex] || op.version != ring.version[op.vertex]) continue;
+        // Changes elsewhere may have moved into its way since it was planned
+        if (!plan(ring, op.vertex, tolerance, op)) continue;
+        apply(ring, op);
+
+        // Plans read two vertices either side
+        size_t v = op.vertex;
+        for (int i = 0; i < 2; ++i) v = ring.prev[v];
+        for (int i = 0; i < 5; ++i, v = ring.next[v]) replan(v);
+    }
+
+    size_t start = 0;
+    while (ring.removed[start]) ++start;
+    Polygon result;
+    result.reserve(ring.count);
+    size_t v = start;
+    do {
+        result.push_back(ring.points[v]);
+        v = ring.next[v];
+    } while (v != start);
+    return result;
+}
+
+Part simplifiedPart(const Part& part, double tolerance)
+{
+    if (!(tolerance > 0) || !(part.scale > 0)) return part;
+    const Polygon outline = simplifyOutward(part.outline, tolerance / part.scale);
+    if (outline.size() >= part.outline.size()) return part;
+    return makePart(part.name, outline, part.scale, part.holes);
+}
+
+} // namespace nest
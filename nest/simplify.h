@@ -0,0 +1,23 @@
+#ifndef NEST_SIMPLIFY_H
+#define NEST_SIMPLIFY_H
+
+#include "part.h"
+
+// Conservative simplification: fewer vertices, never less area. A layout
+// without overlaps between simplified outlines has none between the real
+// ones, so the optimizer can search on cheap outlines and stay valid.
+namespace nest {
+
+// An outline containing poly, with every boundary point within tolerance of
+// poly's boundary. Reflex vertices are cut off by the chord past them and
+// short edges between convex vertices are replaced by extending their
+// neighbours to meet, smallest added area first, while the bound allows.
+// Returns poly unchanged if it is too small to simplify.
+Polygon simplifyOutward(const Polygon& poly, double tolerance);
+
+// part with its outline simplified; tolerance is in scaled (scene) units
+Part simplifiedPart(const Part& part, double tolerance);
+
+} // namespace nest
+
+#endif // NEST_SIMPLIFY_H
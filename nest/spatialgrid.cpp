@@ -0,0 +1,81 @@
+#include "spatialgrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace nest {
+
+SpatialGrid::SpatialGrid(double cellSize) : size(cellSize > 0 ? cellSize : 50.0)
+{
+}
+
+SpatialGrid::CellRange SpatialGrid::cellRange(const Rect& box) const
+{
+    CellRange range;
+    if (box.isEmpty()) return range;
+    range.minX = int64_t(std::floor(box.minX / size));
+    range.minY = int64_t(std::floor(box.minY / size));
+    range.maxX = int64_t(std::floor(box.maxX / size));
+    range.maxY = int64_t(std::floor(box.maxY / size));
+    return range;
+}
+
+void SpatialGrid::insert(int id, const Rect& box)
+{
+    if (id >= int(boxes.size())) {
+        boxes.resize(id + 1);
+        spans.resize(id + 1);
+        visited.resize(id + 1, 0);
+    }
+    boxes[id] = box;
+    spans[id] = cellRange(box);
+    const CellRange& range = spans[id];
+    for (int64_t cx = range.minX; cx <= range.maxX; ++cx) {
+        for (int64_t cy = range.minY; cy <= range.maxY; ++cy) {
+            cells[cellKey(cx, cy)].push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::remove(int id)
+{
+    if (id < 0 || id >= int(boxes.size())) return;
+    const CellRange range = spans[id];
+    for (int64_t cx = range.minX; cx <= range.maxX; ++cx) {
+        for (int64_t cy = range.minY; cy <= range.maxY; ++cy) {
+            auto it = cells.find(cellKey(cx, cy));
+            if (it == cells.end()) continue;
+            // Emptied cells stay, buffers and all, for the next part to move in
+            std::vector<int>& ids = it->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
+        }
+    }
+    boxes[id] = Rect();
+    spans[id] = CellRange();
+}
+
+void SpatialGrid::update(int id, const Rect& box)
+{
+    // Moves within the same cells only need the stored box refreshed
+    if (id < int(boxes.size())) {
+        const CellRange next = cellRange(box);
+        const CellRange& current = spans[id];
+        if (next.minX == current.minX && next.minY == current.minY && next.maxX == current.maxX &&
+            next.maxY == current.maxY && !box.isEmpty()) {
+            boxes[id] = box;
+            return;
+        }
+    }
+    remove(id);
+    insert(id, box);
+}
+
+void SpatialGrid::clear()
+{
+    cells.clear();
+    boxes.clear();
+    spans.clear();
+    visited.clear();
+    stamp = 0;
+}
+
+} // namespace nest
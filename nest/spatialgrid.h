@@ -0,0 +1,73 @@
+#ifndef NEST_SPATIALGRID_H
+#define NEST_SPATIALGRID_H
+
+#include "geometry.h"
+#include "instrumentation.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace nest {
+
+// Broad phase for overlap queries: a sparse uniform grid of bounding boxes,
+// updated incrementally as parts move. Only ids whose boxes share a cell
+// with the query come back, so the exact polygon test runs on a handful of
+// neighbours instead of every placed part. query() marks visited ids in the
+// grid, so one grid must not be queried from several threads at once.
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(double cellSize = 50.0);
+
+    void insert(int id, const Rect& box);
+    void update(int id, const Rect& box);
+    void remove(int id);
+    void clear();
+
+    // Calls fn(id) once for every id whose box intersects box
+    template <typename Fn>
+    void query(const Rect& box, Fn&& fn) const
+    {
+        if (box.isEmpty()) return;
+        if (++stamp == 0) {
+            std::fill(visited.begin(), visited.end(), 0);
+            stamp = 1;
+        }
+        const CellRange range = cellRange(box);
+        for (int64_t cx = range.minX; cx <= range.maxX; ++cx) {
+            for (int64_t cy = range.minY; cy <= range.maxY; ++cy) {
+                auto it = cells.find(cellKey(cx, cy));
+                if (it == cells.end()) continue;
+                for (int id : it->second) {
+                    if (visited[id] == stamp) continue;
+                    visited[id] = stamp;
+                    NEST_COUNT(BroadPhaseTest);
+                    if (boxes[id].intersects(box)) fn(id);
+                }
+            }
+        }
+    }
+
+    double cellSize() const { return size; }
+
+private:
+    struct CellRange
+    {
+        int64_t minX = 0, minY = 0, maxX = -1, maxY = -1;
+    };
+
+    CellRange cellRange(const Rect& box) const;
+    static uint64_t cellKey(int64_t x, int64_t y) { return (uint64_t(uint32_t(x)) << 32) | uint32_t(y); }
+
+    double size;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    std::vector<Rect> boxes;      // Indexed by id
+    std::vector<CellRange> spans; // Cells each id is registered in
+    mutable std::vector<uint32_t> visited;
+    mutable uint32_t stamp = 0;
+};
+
+} // namespace nest
+
+#endif // NEST_SPATIALGRID_H
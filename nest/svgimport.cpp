@@ -0,0 +1,529 @@
+#include "flatten.h"
+#include "importsupport.h"
+#include "partimport.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace nest {
+
+namespace {
+
+// x' = a x + c y + e, y' = b x + d y + f, as in SVG's matrix(a b c d e f)
+struct Affine
+{
+    double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+
+    Point map(const Point& p) const { return {a * p.x + c * p.y + e, b * p.x + d * p.y + f}; }
+
+    // Applies other first, then this
+    Affine operator*(const Affine& o) const
+    {
+        return {a * o.a + c * o.b, b * o.a + d * o.b, a * o.c + c * o.d, b * o.c + d * o.d,
+                a * o.e + c * o.f + e, b * o.e + d * o.f + f};
+    }
+
+    // Largest stretch, so a tolerance can be taken back to local units
+    double stretch() const { return std::max(std::hypot(a, b), std::hypot(c, d)); }
+    bool isIdentity() const { return a == 1 && b == 0 && c == 0 && d == 1 && e == 0 && f == 0; }
+};
+
+struct Tag
+{
+    std::string name;
+    std::string attributes; // The raw text after the name
+    bool closing = false;
+    bool selfClosing = false;
+};
+
+// Pulls tags out of a stream one at a time. Text, comments, CDATA and
+// processing instructions are skipped without being stored.
+class TagReader
+{
+public:
+    explicit TagReader(std::istream& in) : buffer(in.rdbuf()) {}
+
+    bool next(Tag& tag)
+    {
+        for (;;) {
+            int c;
+            while ((c = get()) != EOF && c != '<') {}
+            if (c == EOF) return false;
+
+            c = get();
+            if (c == '!') {
+                const int first = get();
+                if (first == '-' && get() == '-') {
+                    skipPast("-->");
+                } else if (first == '[') {
+                    skipPast("]]>");
+                } else {
+                    skipPast(">");
+                }
+                continue;
+            }
+            if (c == '?') {
+                skipPast("?>");
+                continue;
+            }
+
+            std::string& raw = tag.attributes;
+            raw.clear();
+            char quote = 0;
+            for (; c != EOF; c = get()) {
+                if (quote) {
+                    if (c == quote) quote = 0;
+                } else if (c == '"' || c == '\'') {
+                    quote = char(c);
+                } else if (c == '>') {
+                    break;
+                }
+                raw.push_back(char(c));
+            }
+            if (c == EOF) return false;
+
+            tag.closing = !raw.empty() && raw[0] == '/';
+            tag.selfClosing = !raw.empty() && raw.back() == '/';
+            if (tag.selfClosing) raw.pop_back();
+            size_t nameStart = tag.closing ? 1 : 0;
+            size_t nameEnd = nameStart;
+            while (nameEnd < raw.size() && !std::isspace(static_cast<unsigned char>(raw[nameEnd]))) ++nameEnd;
+            tag.name.assign(raw, nameStart, nameEnd - nameStart);
+            // Namespaced documents write svg:path
+            const size_t colon = tag.name.find(':');
+            if (colon != std::string::npos) tag.name.erase(0, colon + 1);
+            raw.erase(0, nameEnd);
+            return true;
+        }
+    }
+
+private:
+    int get()
+    {
+        const int c = buffer ? buffer->sbumpc() : EOF;
+        return c == std::char_traits<char>::eof() ? EOF : c;
+    }
+
+    void skipPast(const char* terminator)
+    {
+        const size_t length = std::strlen(terminator);
+        std::string window;
+        for (int c; (c = get()) != EOF;) {
+            window.push_back(char(c));
+            if (window.size() > length) window.erase(0, 1);
+            if (window == terminator) return;
+        }
+    }
+
+    std::streambuf* buffer;
+};
+
+bool attribute(const std::string& attributes, const char* name, std::string& value)
+{
+    const size_t nameLength = std::strlen(name);
+    size_t i = 0;
+    while (i < attributes.size()) {
+        while (i < attributes.size() && std::isspace(static_cast<unsigned char>(attributes[i]))) ++i;
+        const size_t start = i;
+        while (i < attributes.size() && attributes[i] != '=' && !std::isspace(static_cast<unsigned char>(attributes[i]))) ++i;
+        const size_t end = i;
+        while (i < attributes.size() && std::isspace(static_cast<unsigned char>(attributes[i]))) ++i;
+        if (i >= attributes.size() || attributes[i] != '=') continue;
+        ++i;
+        while (i < attributes.size() && std::isspace(static_cast<unsigned char>(attributes[i]))) ++i;
+        if (i >= attributes.size()) break;
+        const char quote = attributes[i];
+        if (quote != '"' && quote != '\'') continue;
+        const size_t close = attributes.find(quote, i + 1);
+        if (close == std::string::npos) break;
+        if (end - start == nameLength && attributes.compare(start, nameLength, name) == 0) {
+            value.assign(attributes, i + 1, close - i - 1);
+            return true;
+        }
+        i = close + 1;
+    }
+    return false;
+}
+
+double numberAttribute(const std::string& attributes, const char* name, double fallback = 0.0)
+{
+    std::string text;
+    if (!attribute(attributes, name, text)) return fallback;
+    const char* p = text.data();
+    while (*p && std::isspace(static_cast<unsigned char>(*p))) ++p;
+    double value = fallback;
+    return parseNumber(p, text.data() + text.size(), value) ? value : fallback;
+}
+
+void skipSeparators(const char*& p, const char* end)
+{
+    while (p < end && (std::isspace(static_cast<unsigned char>(*p)) || *p == ',')) ++p;
+}
+
+bool nextNumber(const char*& p, const char* end, double& value)
+{
+    skipSeparators(p, end);
+    return parseNumber(p, end, value);
+}
+
+// Arc flags may be written without separators, as in "a1 1 0 0110 10"
+bool nextFlag(const char*& p, const char* end, bool& flag)
+{
+    skipSeparators(p, end);
+    if (p == end || (*p != '0' && *p != '1')) return false;
+    flag = *p++ == '1';
+    return true;
+}
+
+Affine parseTransform(const std::string& text)
+{
+    Affine result;
+    const char* p = text.data();
+    const char* end = p + text.size();
+    for (;;) {
+        skipSeparators(p, end);
+        const char* nameStart = p;
+        while (p < end && std::isalpha(static_cast<unsigned char>(*p))) ++p;
+        const std::string name(nameStart, p);
+        while (p < end && *p != '(') ++p;
+        if (name.empty() || p == end) break;
+        ++p;
+        double v[6] = {0, 0, 0, 0, 0, 0};
+        int count = 0;
+        while (count < 6 && nextNumber(p, end, v[count])) ++count;
+        while (p < end && *p != ')') ++p;
+        if (p < end) ++p;
+
+        Affine step;
+        if (name == "matrix" && count == 6) {
+            step = {v[0], v[1], v[2], v[3], v[4], v[5]};
+        } else if (name == "translate" && count >= 1) {
+            step.e = v[0];
+            step.f = count > 1 ? v[1] : 0.0;
+        } else if (name == "scale" && count >= 1) {
+            step.a = v[0];
+            step.d = count > 1 ? v[1] : v[0];
+        } else if (name == "rotate" && count >= 1) {
+            const double angle = v[0] * Pi / 180.0;
+            const Affine rotation{std::cos(angle), std::sin(angle), -std::sin(angle), std::cos(angle), 0, 0};
+            const Affine to{1, 0, 0, 1, v[1], v[2]};
+            const Affine from{1, 0, 0, 1, -v[1], -v[2]};
+            step = count >= 3 ? to * rotation * from : rotation;
+        } else if (name == "skewX" && count >= 1) {
+            step.c = std::tan(v[0] * Pi / 180.0);
+        } else if (name == "skewY" && count >= 1) {
+            step.b = std::tan(v[0] * Pi / 180.0);
+        }
+        result = result * step;
+    }
+    return result;
+}
+
+// Center parameterization of an SVG endpoint arc, per the SVG spec's
+// implementation notes, flattened onto out
+void flattenEndpointArc(const Point& from, double rx, double ry, double rotation, bool largeArc, bool sweep,
+                        const Point& to, double tolerance, Polygon& out)
+{
+    rx = std::abs(rx);
+    ry = std::abs(ry);
+    if (from == to) return;
+    if (rx == 0 || ry == 0) {
+        out.push_back(to);
+        return;
+    }
+
+    const double phi = rotation * Pi / 180.0;
+    const double cosPhi = std::cos(phi);
+    const double sinPhi = std::sin(phi);
+    const double dx = (from.x - to.x) * 0.5;
+    const double dy = (from.y - to.y) * 0.5;
+    const double x1 = cosPhi * dx + sinPhi * dy;
+    const double y1 = -sinPhi * dx + cosPhi * dy;
+
+    // Radii too small to span the endpoints grow just enough
+    const double lambda = (x1 * x1) / (rx * rx) + (y1 * y1) / (ry * ry);
+    if (lambda > 1) {
+        rx *= std::sqrt(lambda);
+        ry *= std::sqrt(lambda);
+    }
+
+    const double numerator = rx * rx * ry * ry - rx * rx * y1 * y1 - ry * ry * x1 * x1;
+    const double denominator = rx * rx * y1 * y1 + ry * ry * x1 * x1;
+    double coefficient = denominator > 0 ? std::sqrt(std::max(0.0, numerator / denominator)) : 0.0;
+    if (largeArc == sweep) coefficient = -coefficient;
+    const double cx1 = coefficient * rx * y1 / ry;
+    const double cy1 = -coefficient * ry * x1 / rx;
+    const Point center{cosPhi * cx1 - sinPhi * cy1 + (from.x + to.x) * 0.5,
+                       sinPhi * cx1 + cosPhi * cy1 + (from.y + to.y) * 0.5};
+
+    const double start = std::atan2((y1 - cy1) / ry, (x1 - cx1) / rx);
+    double delta = std::atan2((-y1 - cy1) / ry, (-x1 - cx1) / rx) - start;
+    if (!sweep && delta > 0) delta -= 2 * Pi;
+    if (sweep && delta < 0) delta += 2 * Pi;
+
+    flattenArc(center, rx, ry, phi, start, delta, tolerance, out);
+    out.back() = to;
+}
+
+bool isNear(const Point& a, const Point& b, double tolerance)
+{
+    return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance;
+}
+
+// Calls ring for each closed subpath of path data d: closed by Z, or with
+// its ends within tolerance. Parsing stops at the first error, as the SVG
+// spec has renderers draw the path up to there.
+template <typename Fn>
+void flattenPath(const std::string& d, double tolerance, Polygon& current, Fn&& ring)
+{
+    const char* p = d.data();
+    const char* end = p + d.size();
+    Point position, start, control;
+    char command = 0;
+    char previous = 0;
+    current.clear();
+
+    auto finish = [&](bool closed) {
+        if (current.size() >= 3 && (closed || isNear(current.front(), current.back(), tolerance))) ring(current);
+        current.clear();
+    };
+
+    for (;;) {
+        skipSeparators(p, end);
+        if (p == end) break;
+        if (std::isalpha(static_cast<unsigned char>(*p))) {
+            command = *p++;
+            if (command == 'Z' || command == 'z') {
+                finish(true);
+                position = start;
+                previous = 'Z';
+                continue;
+            }
+        } else if (!command || command == 'Z' || command == 'z') {
+            break;
+        }
+
+        const bool relative = std::islower(static_cast<unsigned char>(command));
+        const Point base = relative ? position : Point();
+        const char type = char(std::toupper(static_cast<unsigned char>(command)));
+        if (type != 'M' && current.empty()) current.push_back(position);
+
+        double v[6];
+        bool ok = true;
+        auto read = [&](int count) {
+            for (int i = 0; i < count && ok; ++i) ok = nextNumber(p, end, v[i]);
+            return ok;
+        };
+
+        switch (type) {
+        case 'M':
+            if (!read(2)) break;
+            finish(false);
+            position = base + Point{v[0], v[1]};
+            start = position;
+            current.push_back(position);
+            command = relative ? 'l' : 'L'; // Further pairs are line segments
+            break;
+        case 'L':
+            if (!read(2)) break;
+            position = base + Point{v[0], v[1]};
+            current.push_back(position);
+            break;
+        case 'H':
+            if (!read(1)) break;
+            position.x = base.x + v[0];
+            current.push_back(position);
+            break;
+        case 'V':
+            if (!read(1)) break;
+            position.y = base.y + v[0];
+            current.push_back(position);
+            break;
+        case 'C': {
+            if (!read(6)) break;
+            const Point c1 = base + Point{v[0], v[1]};
+            control = base + Point{v[2], v[3]};
+            const Point to = base + Point{v[4], v[5]};
+            flattenCubic(position, c1, control, to, tolerance, current);
+            position = to;
+            break;
+        }
+        case 'S': {
+            if (!read(4)) break;
+            const Point c1 = previous == 'C' || previous == 'S' ? position * 2.0 - control : position;
+            control = base + Point{v[0], v[1]};
+            const Point to = base + Point{v[2], v[3]};
+            flattenCubic(position, c1, control, to, tolerance, current);
+            position = to;
+            break;
+        }
+        case 'Q': {
+            if (!read(4)) break;
+            control = base + Point{v[0], v[1]};
+            const Point to = base + Point{v[2], v[3]};
+            flattenQuadratic(position, control, to, tolerance, current);
+            position = to;
+            break;
+        }
+        case 'T': {
+            if (!read(2)) break;
+            control = previous == 'Q' || previous == 'T' ? position * 2.0 - control : position;
+            const Point to = base + Point{v[0], v[1]};
+            flattenQuadratic(position, control, to, tolerance, current);
+            position = to;
+            break;
+        }
+        case 'A': {
+            bool largeArc = false;
+            bool sweep = false;
+            ok = read(3) && nextFlag(p, end, largeArc) && nextFlag(p, end, sweep) && nextNumber(p, end, v[3]) &&
+                 nextNumber(p, end, v[4]);
+            if (!ok) break;
+            const Point to = base + Point{v[3], v[4]};
+            flattenEndpointArc(position, v[0], v[1], v[2], largeArc, sweep, to, tolerance, current);
+            position = to;
+            break;
+        }
+        default:
+            ok = false;
+        }
+        if (!ok) break;
+        previous = type;
+    }
+    finish(false);
+}
+
+void readPoints(const std::string& text, Polygon& out)
+{
+    out.clear();
+    const char* p = text.data();
+    const char* end = p + text.size();
+    double x, y;
+    while (nextNumber(p, end, x) && nextNumber(p, end, y)) out.push_back({x, y});
+}
+
+bool isHiddenContainer(const std::string& name)
+{
+    return name == "defs" || name == "clipPath" || name == "mask" || name == "marker" || name == "pattern" ||
+           name == "symbol";
+}
+
+struct Frame
+{
+    std::string name;
+    Affine transform;
+    bool hidden = false;
+};
+
+} // namespace
+
+bool importSvg(std::istream& in, PartLibrary& library, const ImportOptions& options, std::string& error)
+{
+    if (!in) {
+        error = "cannot read SVG";
+        return false;
+    }
+
+    TagReader reader(in);
+    RingSet rings;
+    std::vector<Frame> stack(1);
+    Tag tag;
+    Polygon ring;
+    std::string text;
+    std::string name;
+    bool sawSvg = false;
+    size_t elements = 0;
+
+    while (reader.next(tag)) {
+        if (tag.closing) {
+            // Pop to the matching element, tolerating unbalanced markup
+            for (size_t i = stack.size(); i-- > 1;) {
+                if (stack[i].name == tag.name) {
+                    stack.resize(i);
+                    break;
+                }
+            }
+            continue;
+        }
+        if (tag.name == "svg") sawSvg = true;
+
+        Frame frame;
+        frame.name = tag.name;
+        frame.transform = stack.back().transform;
+        if (attribute(tag.attributes, "transform", text)) frame.transform = frame.transform * parseTransform(text);
+        frame.hidden = stack.back().hidden || isHiddenContainer(tag.name);
+        if (!tag.selfClosing) stack.push_back(frame);
+        if (frame.hidden) continue;
+
+        // The tolerance applies after scaling and transforming; curves are flattened before either
+        const double stretch = frame.transform.stretch() * std::abs(options.scale);
+        const double tolerance = stretch > 0 ? options.tolerance / stretch : options.tolerance;
+        if (!attribute(tag.attributes, "id", name)) name = tag.name + " " + std::to_string(elements + 1);
+        auto emit = [&](Polygon& points) {
+            if (!frame.transform.isIdentity()) {
+                for (Point& p : points) p = frame.transform.map(p);
+            }
+            rings.add(name, points);
+        };
+
+        const std::string& a = tag.attributes;
+        if (tag.name == "path") {
+            if (attribute(a, "d", text)) flattenPath(text, tolerance, ring, emit);
+        } else if (tag.name == "polygon" || tag.name == "polyline") {
+            if (!attribute(a, "points", text)) continue;
+            readPoints(text, ring);
+            if (ring.size() >= 3 && (tag.name == "polygon" || isNear(ring.front(), ring.back(), tolerance))) {
+                emit(ring);
+            }
+        } else if (tag.name == "rect") {
+            const double x = numberAttribute(a, "x");
+            const double y = numberAttribute(a, "y");
+            const double w = numberAttribute(a, "width");
+            const double h = numberAttribute(a, "height");
+            if (w <= 0 || h <= 0) continue;
+            double rx = numberAttribute(a, "rx", -1);
+            double ry = numberAttribute(a, "ry", -1);
+            if (rx < 0) rx = ry;
+            if (ry < 0) ry = rx;
+            rx = std::min(std::max(rx, 0.0), w / 2);
+            ry = std::min(std::max(ry, 0.0), h / 2);
+            ring.clear();
+            if (rx > 0 && ry > 0) {
+                ring.push_back({x + rx, y});
+                ring.push_back({x + w - rx, y});
+                flattenArc({x + w - rx, y + ry}, rx, ry, 0, -Pi / 2, Pi / 2, tolerance, ring);
+                ring.push_back({x + w, y + h - ry});
+                flattenArc({x + w - rx, y + h - ry}, rx, ry, 0, 0, Pi / 2, tolerance, ring);
+                ring.push_back({x + rx, y + h});
+                flattenArc({x + rx, y + h - ry}, rx, ry, 0, Pi / 2, Pi / 2, tolerance, ring);
+                ring.push_back({x, y + ry});
+                flattenArc({x + rx, y + ry}, rx, ry, 0, Pi, Pi / 2, tolerance, ring);
+            } else {
+                ring = {{x, y}, {x + w, y}, {x + w, y + h}, {x, y + h}};
+            }
+            emit(ring);
+        } else if (tag.name == "circle" || tag.name == "ellipse") {
+            const Point center{numberAttribute(a, "cx"), numberAttribute(a, "cy")};
+            const double rx = numberAttribute(a, tag.name == "circle" ? "r" : "rx");
+            const double ry = numberAttribute(a, tag.name == "circle" ? "r" : "ry");
+            if (rx <= 0 || ry <= 0) continue;
+            ring.clear();
+            flattenArc(center, rx, ry, 0, 0, 2 * Pi, tolerance, ring);
+            ring.pop_back(); // Back at the start
+            emit(ring);
+        } else {
+            continue;
+        }
+        ++elements;
+    }
+
+    if (!sawSvg) {
+        error = "not an SVG document";
+        return false;
+    }
+    rings.addPartsTo(library, options.scale);
+    return true;
+}
+
+} // namespace nest
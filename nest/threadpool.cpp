@@ -0,0 +1,106 @@
+#include "threadpool.h"
+
+namespace nest {
+
+ThreadPool::ThreadPool(int threads)
+{
+    if (threads <= 0) threads = int(std::thread::hardware_concurrency());
+    if (threads <= 0) threads = 1;
+    blocks.reset(new Block[threads]);
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, size_t(i - 1));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (count == 0) return;
+    const size_t threads = workers.size() + 1;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (size_t t = 0; t < threads; ++t) {
+        std::lock_guard<std::mutex> blockLock(blocks[t].mutex);
+        blocks[t].next = count * t / threads;
+        blocks[t].end = count * (t + 1) / threads;
+    }
+    task = &fn;
+    ++generation;
+    ++running;
+    lock.unlock();
+    wake.notify_all();
+
+    runBlocks(workers.size(), fn);
+
+    // Nothing is left to claim; wait for the calls still running elsewhere
+    lock.lock();
+    --running;
+    done.wait(lock, [this] { return running == 0; });
+    task = nullptr;
+}
+
+void ThreadPool::runBlocks(size_t self, const std::function<void(size_t)>& fn)
+{
+    size_t index;
+    while (claim(self, index)) fn(index);
+}
+
+// Next index from this thread's own block, else from a stolen one
+bool ThreadPool::claim(size_t self, size_t& index)
+{
+    Block& own = blocks[self];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.next < own.end) {
+            index = own.next++;
+            return true;
+        }
+    }
+    const size_t threads = workers.size() + 1;
+    for (size_t k = 1; k < threads; ++k) {
+        Block& victim = blocks[(self + k) % threads];
+        size_t from, to;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            const size_t left = victim.end - victim.next;
+            if (left == 0) continue;
+            from = victim.end - (left + 1) / 2;
+            to = victim.end;
+            victim.end = from;
+        }
+        // Only one block lock is ever held, so thieves cannot deadlock
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.next = from + 1;
+        own.end = to;
+        index = from;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self)
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [&] { return stopping || (task && generation != seen); });
+        if (stopping) return;
+        seen = generation;
+        const std::function<void(size_t)>& fn = *task;
+        ++running;
+        lock.unlock();
+        runBlocks(self, fn);
+        lock.lock();
+        if (--running == 0) done.notify_all();
+    }
+}
+
+} // namespace nest
@@ -0,0 +1,59 @@
+#ifndef NEST_THREADPOOL_H
+#define NEST_THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nest {
+
+// Fixed set of worker threads for the optimizer's data-parallel phases
+class ThreadPool
+{
+public:
+    // threads <= 0 uses one per hardware core
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Run fn(0) .. fn(count - 1) across the workers and the calling thread,
+    // returning once all calls have finished. Thread t starts on the t-th of
+    // threadCount() equal blocks of indices, front to back; one that runs
+    // out steals the back half of another's remaining block, so calls of
+    // very different cost still keep every thread busy.
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+    int threadCount() const { return int(workers.size()) + 1; }
+
+private:
+    // Indices [next, end) a thread has still to run
+    struct Block
+    {
+        std::mutex mutex;
+        size_t next = 0;
+        size_t end = 0;
+    };
+
+    void workerLoop(size_t self);
+    void runBlocks(size_t self, const std::function<void(size_t)>& fn);
+    bool claim(size_t self, size_t& index);
+
+    std::vector<std::thread> workers;
+    std::unique_ptr<Block[]> blocks; // One per thread, the calling thread's last
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    const std::function<void(size_t)>* task = nullptr;
+    uint64_t generation = 0; // Bumped by each parallelFor
+    size_t running = 0;      // Threads inside runBlocks
+    bool stopping = false;
+};
+
+} // namespace nest
+
+#endif // NEST_THREADPOOL_H
@@ -10,15 +10,17 @@ QT += widgets gui
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    arrangeworker.cpp \
     main.cpp \
     mainwindow.cpp \
-    myscene.cpp \
-    nfpcalculator.cpp
+    myscene.cpp
 
 HEADERS += \
+    arrangeworker.h \
     mainwindow.h \
-    myscene.h \
-    nfpcalculator.h
+    myscene.h
+
+include(nest/nest.pri)
 
 FORMS += \
     mainwindow.ui